@@ -0,0 +1,39 @@
+#include "batch_solver.h"
+#include "lyne_solver.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+std::vector <BatchResult> solveBatch(std::vector <NodeMatrix> const& boards, SolveOptions const& options, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, std::max(1u, static_cast <unsigned> (boards.size())));
+
+    // every task writes its own result only
+    std::vector <BatchResult> results(boards.size());
+    std::vector <WorkStealingPool::Task> tasks;
+    for (std::size_t i = 0; i != boards.size(); ++i)
+    {
+        tasks.push_back([&boards, &options, &results, i](unsigned)
+        {
+            auto& result = results[i];
+            try
+            {
+                LYNESolver solver(boards[i]);
+                result.paths = solver.solve(result.stepCounter, result.backtrackCounter, options);
+                result.statistics = solver.getStatistics();
+            }
+            catch (std::exception const& exc)
+            {
+                result.error = exc.what();
+            }
+        });
+    }
+
+    WorkStealingPool pool(threads);
+    pool.run(std::move(tasks));
+    return results;
+}
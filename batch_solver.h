@@ -0,0 +1,25 @@
+#ifndef BATCH_SOLVER_H_INCLUDED
+#define BATCH_SOLVER_H_INCLUDED
+
+#include "node_matrix.h"
+#include "path.h"
+#include "solve_options.h"
+#include "solve_statistics.h"
+
+#include <string>
+#include <vector>
+
+struct BatchResult
+{
+    std::vector <NodePath> paths;
+    long long stepCounter = 0;
+    long long backtrackCounter = 0;
+    SolveStatistics statistics;
+    std::string error; // why the board was not solved, empty if it was
+};
+
+// solves every board with a LYNESolver of its own, on at most threads threads (0 uses every core).
+// The results are in the order of the boards, a failed board does not stop the others.
+std::vector <BatchResult> solveBatch(std::vector <NodeMatrix> const& boards, SolveOptions const& options = SolveOptions(), unsigned threads = 0);
+
+#endif // BATCH_SOLVER_H_INCLUDED
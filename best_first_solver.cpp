@@ -0,0 +1,348 @@
+#include "best_first_solver.h"
+#include "move_ordering.h"
+#include "path_bounds.h"
+#include "propagation.h"
+#include "reachability.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+BestFirstSolver::BestFirstSolver (NodeMatrix const& board, SolveOptions const& options, HamiltonianOracle const* oracle)
+    : board_(board)
+    , oracle_(oracle)
+    , scoring_(options.scoring)
+    , beamWidth_(options.beamWidth)
+    , state_(board)
+    , startMark_(0)
+    , cursors_()
+    , starts_()
+    , targets_()
+    , shapes_(board.getShapeList())
+    , nodes_()
+    , known_()
+    , solution_(-1)
+    , deepest_(0)
+    , deepestDepth_(0)
+    , budget_(nullptr)
+{
+    for (auto const& i : shapes_)
+    {
+        auto endpoints = board.getStartEndPair(i);
+        if (!endpoints)
+            throw std::runtime_error("board is invalid");
+        starts_.push_back(board.getIndex(endpoints.get().first));
+        targets_.push_back(board.getIndex(endpoints.get().second));
+    }
+}
+
+void BestFirstSolver::restore(int node, BoardState& state, Cursors& cursors)
+{
+    std::vector <int> chain;
+    for (; node != -1; node = nodes_[node].parent)
+        chain.push_back(node);
+
+    state.undo(startMark_);
+    cursors.positions = starts_;
+    cursors.visited.assign(starts_.size(), 0);
+    for (std::size_t i = 0; i != starts_.size(); ++i)
+        cursors.visited[i] = cellBit(starts_[i]);
+
+    // the root holds no step
+    for (auto i = chain.rbegin() + 1; i < chain.rend(); ++i)
+    {
+        auto const& step = nodes_[*i];
+        auto position = cursors.positions[step.shapeIndex];
+        auto cells = board_.getEdgeCells(step.edge);
+        auto next = cells.first == position ? cells.second : cells.first;
+
+        for (auto const& neighbour : board_.getNeighbours(position))
+        {
+            if (neighbour.cell == next)
+            {
+                makeStep(state, cursors, step.shapeIndex, neighbour);
+                break;
+            }
+        }
+    }
+}
+
+bool BestFirstSolver::makeStep(BoardState& state, Cursors& cursors, int shapeIndex, Neighbour const& next) const
+{
+    auto shape = shapes_[shapeIndex];
+    if (state.isPending(next.edge))
+    {
+        // deduced earlier, the path only has to follow it.
+        if (state.getEdgeShape(next.edge) != shape)
+            return false;
+        state.walk(next.edge);
+    }
+    else
+    {
+        auto position = cursors.positions[shapeIndex];
+        if (state.isConnected(next.edge) || state.getRemainingValence(position) == 0 || state.getRemainingValence(next.cell) == 0)
+            return false;
+
+        auto crossing = board_.getCrossingEdge(next.edge);
+        if (crossing != -1 && state.isConnected(crossing))
+            return false;
+
+        auto nextShape = board_.getShape(next.cell);
+        if (nextShape != shape && nextShape != NodeShape::ValenceRestricted)
+            return false;
+
+        state.connect(next.edge, shapeIndex);
+        if (!propagate(state, getAffectedCells(board_, next.edge)))
+            return false;
+    }
+
+    cursors.positions[shapeIndex] = next.cell;
+    cursors.visited[shapeIndex] |= cellBit(next.cell);
+    return true;
+}
+
+bool BestFirstSolver::couldComplete(BoardState const& state, Cursors const& cursors, int shapeIndex) const
+{
+    auto position = cursors.positions[shapeIndex];
+    auto target = targets_[shapeIndex];
+    if (position == target)
+        return state.isShapeSatisfied(shapeIndex) && state.getPendingCount(shapeIndex) == 0;
+
+    if (!canReachShape(state, shapeIndex, position, target) || !isWithinPathBounds(state, shapeIndex, position, target))
+        return false;
+    return oracle_ == nullptr || oracle_->canComplete(shapeIndex, cursors.visited[shapeIndex], position);
+}
+
+int BestFirstSolver::selectShape(BoardState const& state, Cursors const& cursors) const
+{
+    int best = -1;
+    int bestOptions = 0;
+    for (int i = 0; i != static_cast <int> (shapes_.size()); ++i)
+    {
+        if (cursors.positions[i] == targets_[i])
+            continue;
+
+        auto options = countOnwardOptions(state, cursors.positions[i], shapes_[i], -1);
+        if (best == -1 || options < bestOptions)
+        {
+            best = i;
+            bestOptions = options;
+        }
+    }
+    return best;
+}
+
+double BestFirstSolver::score(BoardState const& state, Cursors const& cursors, int depth) const
+{
+    // lower is better. Every remaining edge counts for two valences.
+    double remaining = 0;
+    for (int i = 0; i != static_cast <int> (shapes_.size()); ++i)
+        remaining += state.getRemainingValenceSum(i);
+    remaining += state.getRemainingRestrictedValence();
+    remaining -= 2 * state.getPendingCount();
+
+    switch (scoring_)
+    {
+    case StateScoring::RemainingVisits:
+        return remaining;
+    case StateScoring::Constrainedness:
+    {
+        // a state whose paths have few options left is close to being decided
+        double options = 0;
+        for (int i = 0; i != static_cast <int> (shapes_.size()); ++i)
+        {
+            if (cursors.positions[i] != targets_[i])
+                options += countOnwardOptions(state, cursors.positions[i], shapes_[i], -1);
+        }
+        return remaining + options;
+    }
+    case StateScoring::Depth:
+        return -depth;
+    }
+    return remaining;
+}
+
+std::uint64_t BestFirstSolver::getStateHash(BoardState const& state, Cursors const& cursors) const
+{
+    auto hash = state.getHash();
+    for (std::size_t i = 0; i != cursors.positions.size(); ++i)
+    {
+        // splitmix64 of shape and cell
+        auto key = static_cast <std::uint64_t> (i * maxMatrixCells + cursors.positions[i]) + 0x9e3779b97f4a7c15ull;
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+        hash ^= key ^ (key >> 31);
+    }
+    return hash;
+}
+
+int BestFirstSolver::expand(int node, int depth, std::vector <Child>& children, long long& stepCounter)
+{
+    auto& state = state_;
+    auto& cursors = cursors_;
+    restore(node, state, cursors);
+
+    auto shapeIndex = selectShape(state, cursors);
+    if (shapeIndex == -1)
+        return 0;
+
+    int count = 0;
+    for (auto const& next : board_.getNeighbours(cursors.positions[shapeIndex]))
+    {
+        auto mark = state.mark();
+        auto position = cursors.positions[shapeIndex];
+        auto visited = cursors.visited[shapeIndex];
+
+        bool valid = makeStep(state, cursors, shapeIndex, next);
+        for (int i = 0; valid && i != static_cast <int> (shapes_.size()); ++i)
+            valid = couldComplete(state, cursors, i);
+
+        if (valid && known_.insert(getStateHash(state, cursors)).second)
+        {
+            stepCounter++;
+            nodes_.push_back(SearchNode{node, static_cast <std::int16_t> (next.edge), static_cast <std::int16_t> (shapeIndex)});
+            auto child = static_cast <int> (nodes_.size()) - 1;
+            if (isSolution(state, cursors))
+            {
+                solution_ = child;
+                return -1;
+            }
+            children.push_back(Child{score(state, cursors, depth + 1), child});
+            ++count;
+
+            if (depth + 1 > deepestDepth_)
+            {
+                deepest_ = child;
+                deepestDepth_ = depth + 1;
+            }
+        }
+
+        state.undo(mark);
+        cursors.positions[shapeIndex] = position;
+        cursors.visited[shapeIndex] = visited;
+    }
+    return count;
+}
+
+std::vector <NodePath> BestFirstSolver::solve(long long& stepCounter, long long& backtrackCounter)
+{
+    state_.undo(0);
+    if (!propagate(state_, board_.getNodeCells()))
+        throw std::runtime_error("No solution");
+    startMark_ = state_.mark();
+
+    nodes_.assign(1, SearchNode{-1, 0, 0});
+    known_.clear();
+    solution_ = -1;
+    deepest_ = 0;
+    deepestDepth_ = 0;
+
+    long long expansions = 0; // not charged to the budget yet
+    auto checkBudget = [&]()
+    {
+        if (budget_ != nullptr && budget_->countStep(expansions))
+        {
+            budget_->offerPartial(getPathes(deepest_), deepestDepth_);
+            budget_->interrupt();
+        }
+    };
+
+    auto byScore = [](Child const& lhs, Child const& rhs)
+    {
+        return lhs.score < rhs.score || (lhs.score == rhs.score && lhs.node > rhs.node);
+    };
+
+    std::vector <Child> children;
+    if (beamWidth_ == 0)
+    {
+        // the newest state wins ties, which keeps a single path going like depth first
+        auto worse = [&](std::pair <Child, int> const& lhs, std::pair <Child, int> const& rhs)
+        {
+            return byScore(rhs.first, lhs.first);
+        };
+        std::priority_queue <std::pair <Child, int>, std::vector <std::pair <Child, int> >, decltype(worse)> open(worse);
+        open.push({Child{0, 0}, 0});
+        while (!open.empty() && solution_ == -1)
+        {
+            checkBudget();
+            auto best = open.top();
+            open.pop();
+
+            children.clear();
+            if (expand(best.first.node, best.second, children, stepCounter) == 0)
+                backtrackCounter++;
+            for (auto const& i : children)
+                open.push({i, best.second + 1});
+        }
+    }
+    else
+    {
+        // every step adds one edge, so all states of a layer have the same depth
+        std::vector <Child> layer{Child{0, 0}};
+        for (int depth = 0; !layer.empty() && solution_ == -1; ++depth)
+        {
+            children.clear();
+            for (auto const& i : layer)
+            {
+                checkBudget();
+                if (expand(i.node, depth, children, stepCounter) == 0)
+                    backtrackCounter++;
+                if (solution_ != -1)
+                    break;
+            }
+
+            if (children.size() > beamWidth_)
+            {
+                std::partial_sort(children.begin(), children.begin() + beamWidth_, children.end(), byScore);
+                backtrackCounter += children.size() - beamWidth_;
+                children.resize(beamWidth_);
+            }
+            layer.swap(children);
+        }
+    }
+
+    // the beam may have dropped the solution, without one the search was complete
+    if (solution_ == -1)
+        throw std::runtime_error(beamWidth_ == 0 ? "No solution" : "No solution within the beam width");
+    return getPathes(solution_);
+}
+
+void BestFirstSolver::setBudget(SolveBudget* budget)
+{
+    budget_ = budget;
+}
+
+std::vector <NodePath> BestFirstSolver::getPathes(int node) const
+{
+    // follow the steps once more, recording the cells of every path
+    std::vector <std::vector <CellIndex> > cells(shapes_.size());
+    for (std::size_t i = 0; i != shapes_.size(); ++i)
+        cells[i].push_back(starts_[i]);
+
+    std::vector <int> chain;
+    for (; node != -1; node = nodes_[node].parent)
+        chain.push_back(node);
+    for (auto i = chain.rbegin() + 1; i < chain.rend(); ++i)
+    {
+        auto const& step = nodes_[*i];
+        auto ends = board_.getEdgeCells(step.edge);
+        auto& path = cells[step.shapeIndex];
+        path.push_back(ends.first == path.back() ? ends.second : ends.first);
+    }
+
+    // paths are reported from the target back to the start
+    std::vector <NodePath> pathes;
+    for (auto const& i : cells)
+    {
+        NodePath path;
+        for (auto cell = i.rbegin(); cell != i.rend(); ++cell)
+            path.push_back(board_.getPixelPosition(*cell));
+        pathes.push_back(path);
+    }
+    return pathes;
+}
+
+std::size_t BestFirstSolver::getStateCount() const
+{
+    return nodes_.size();
+}
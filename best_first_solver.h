@@ -0,0 +1,97 @@
+#ifndef BEST_FIRST_SOLVER_H_INCLUDED
+#define BEST_FIRST_SOLVER_H_INCLUDED
+
+#include "board_state.h"
+#include "hamiltonian_oracle.h"
+#include "node_matrix.h"
+#include "path.h"
+#include "solve_budget.h"
+#include "solve_options.h"
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+/**
+ *  Searches the partial states of a board best first instead of depth first.
+ *  A state is stored as the step that lead to it and its parent, and replayed from the
+ *  start when it is expanded. Memory goes mostly to the set of known state hashes, about
+ *  40 bytes per state, and the open queue. Each expansion moves the shape with the fewest
+ *  options, like the interleaved cursor search.
+ *
+ *  With a beam width only that many states of each depth are kept. That bounds time and
+ *  memory, but may miss the solution.
+ */
+class BestFirstSolver
+{
+public:
+    BestFirstSolver (NodeMatrix const& board, SolveOptions const& options, HamiltonianOracle const* oracle = nullptr);
+
+    // paths in the order of NodeMatrix::getShapeList(), from the target back to the start
+    std::vector <NodePath> solve(long long& stepCounter, long long& backtrackCounter);
+
+    // checked before every expansion, the deepest state so far is the partial state
+    void setBudget(SolveBudget* budget);
+
+    std::size_t getStateCount() const;
+
+private:
+    struct SearchNode
+    {
+        std::int32_t parent; // -1 for the start
+        std::int16_t edge;
+        std::int16_t shapeIndex;
+    };
+
+    // where the paths stand, the edges are in the BoardState
+    struct Cursors
+    {
+        std::vector <CellIndex> positions; // per shape
+        std::vector <CellMask> visited;
+    };
+
+    struct Child
+    {
+        double score;
+        int node;
+    };
+
+    void restore(int node, BoardState& state, Cursors& cursors);
+    bool makeStep(BoardState& state, Cursors& cursors, int shapeIndex, Neighbour const& next) const;
+    bool couldComplete(BoardState const& state, Cursors const& cursors, int shapeIndex) const;
+    int selectShape(BoardState const& state, Cursors const& cursors) const;
+    double score(BoardState const& state, Cursors const& cursors, int depth) const;
+    std::uint64_t getStateHash(BoardState const& state, Cursors const& cursors) const;
+
+    inline bool isSolution(BoardState const& state, Cursors const& cursors) const
+    {
+        return state.isSolved() && state.getPendingCount() == 0 && cursors.positions == targets_;
+    }
+
+    // the children of the node that are not known yet, -1 if one of them solves the board
+    int expand(int node, int depth, std::vector <Child>& children, long long& stepCounter);
+    std::vector <NodePath> getPathes(int node) const;
+
+private:
+    NodeMatrix const& board_;
+    HamiltonianOracle const* oracle_;
+    StateScoring scoring_;
+    std::size_t beamWidth_;
+
+    BoardState state_; // reused by every expansion, rewound to startMark_ in between
+    BoardState::TrailMark startMark_; // deductions for the empty board below
+    Cursors cursors_;
+    std::vector <CellIndex> starts_; // per shape
+    std::vector <CellIndex> targets_;
+    std::vector <NodeShape> shapes_;
+
+    std::vector <SearchNode> nodes_;
+    std::unordered_set <std::uint64_t> known_; // hashes of all states in nodes_
+    int solution_;
+    int deepest_; // the node of the greatest depth
+    int deepestDepth_;
+
+    SolveBudget* budget_;
+};
+
+#endif // BEST_FIRST_SOLVER_H_INCLUDED
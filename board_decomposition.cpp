@@ -0,0 +1,123 @@
+#include "board_decomposition.h"
+
+#include <numeric>
+
+namespace
+{
+    int findRoot(std::vector <int>& parents, int shapeIndex)
+    {
+        while (parents[shapeIndex] != shapeIndex)
+            shapeIndex = parents[shapeIndex] = parents[parents[shapeIndex]];
+        return shapeIndex;
+    }
+}
+
+CellMask getShapeRange(NodeMatrix const& board, int shapeIndex)
+{
+    auto restricted = board.getValenceRestrictedCells();
+    auto range = board.getShapeCells(shapeIndex);
+    for (;;)
+    {
+        auto next = range | (board.growCells(range) & restricted);
+        if (next == range)
+            return range;
+        range = next;
+    }
+}
+
+std::vector <std::vector <int> > findIndependentGroups(NodeMatrix const& board)
+{
+    auto shapeCount = board.getShapeCount();
+    std::vector <CellMask> ranges;
+    CellMask reached = 0;
+    for (int i = 0; i != shapeCount; ++i)
+    {
+        ranges.push_back(getShapeRange(board, i));
+        reached |= ranges.back();
+    }
+
+    std::vector <std::vector <int> > groups;
+    if (shapeCount == 0)
+        return groups;
+
+    std::vector <int> all(shapeCount);
+    std::iota(all.begin(), all.end(), 0);
+    if (board.getValenceRestrictedCells() & ~reached)
+    {
+        groups.push_back(all);
+        return groups;
+    }
+
+    // union find over the shapes
+    auto parents = all;
+    auto join = [&](int lhs, int rhs)
+    {
+        parents[findRoot(parents, lhs)] = findRoot(parents, rhs);
+    };
+
+    // shared valence restricted nodes
+    for (int i = 0; i != shapeCount; ++i)
+    {
+        for (int j = i + 1; j != shapeCount; ++j)
+        {
+            if (ranges[i] & ranges[j] & board.getValenceRestrictedCells())
+                join(i, j);
+        }
+    }
+
+    // crossing diagonals, an edge is usable by a shape if both of its cells are in range.
+    auto getUsers = [&](EdgeIndex edge)
+    {
+        std::vector <int> users;
+        auto cells = board.getEdgeCells(edge);
+        if (cells.first == -1)
+            return users;
+
+        auto both = cellBit(cells.first) | cellBit(cells.second);
+        for (int i = 0; i != shapeCount; ++i)
+        {
+            if ((ranges[i] & both) == both)
+                users.push_back(i);
+        }
+        return users;
+    };
+    for (EdgeIndex edge = 0; edge != board.getEdgeCount(); ++edge)
+    {
+        auto crossing = board.getCrossingEdge(edge);
+        if (crossing == -1 || crossing < edge)
+            continue;
+        for (auto i : getUsers(edge))
+        {
+            for (auto j : getUsers(crossing))
+                join(i, j);
+        }
+    }
+
+    std::vector <int> groupOf(shapeCount, -1);
+    for (int i = 0; i != shapeCount; ++i)
+    {
+        auto& group = groupOf[findRoot(parents, i)];
+        if (group == -1)
+        {
+            group = static_cast <int> (groups.size());
+            groups.emplace_back();
+        }
+        groups[group].push_back(i);
+    }
+    return groups;
+}
+
+NodeMatrix extractGroup(NodeMatrix const& board, std::vector <int> const& group)
+{
+    CellMask cells = 0;
+    for (auto i : group)
+        cells |= getShapeRange(board, i);
+
+    std::vector <Node> nodes(board.getCellCount());
+    for (auto rest = cells; rest; )
+    {
+        auto cell = popCell(rest);
+        nodes[cell] = board.get(board.getMatrixPosition(cell));
+    }
+    return NodeMatrix(board.getWidth(), board.getHeight(), nodes);
+}
@@ -0,0 +1,24 @@
+#ifndef BOARD_DECOMPOSITION_H_INCLUDED
+#define BOARD_DECOMPOSITION_H_INCLUDED
+
+#include "node_matrix.h"
+
+#include <vector>
+
+/**
+ *  Two shapes only interact through valence restricted nodes both of them can reach and
+ *  through diagonals of one that cross diagonals of the other. Groups of shapes without
+ *  such interactions can be solved on boards of their own.
+ */
+
+// shape indices of NodeMatrix::getShapeList(), one entry per group. A single group if
+// some valence restricted node can not be reached by any shape, the board is unsolvable then.
+std::vector <std::vector <int> > findIndependentGroups(NodeMatrix const& board);
+
+// the board with the nodes of the group's shapes and the valence restricted nodes they can reach
+NodeMatrix extractGroup(NodeMatrix const& board, std::vector <int> const& group);
+
+// cells the shape can ever visit, its own nodes and the valence restricted nodes next to them
+CellMask getShapeRange(NodeMatrix const& board, int shapeIndex);
+
+#endif // BOARD_DECOMPOSITION_H_INCLUDED
@@ -0,0 +1,151 @@
+#ifndef BOARD_GEOMETRY_H_INCLUDED
+#define BOARD_GEOMETRY_H_INCLUDED
+
+#include "node_matrix.h"
+
+#include <cstdint>
+
+/**
+ *  Geometries tell the search kernel how cells, directions and edges relate.
+ *  StaticGeometry knows the board size at compile time, so all offsets fold into constants
+ *  and the direction loop is unrolled. DynamicGeometry uses the tables of the NodeMatrix.
+ */
+template <typename Geometry, int Direction>
+struct DirectionLoop
+{
+    template <typename Function>
+    static inline bool until(CellIndex cell, std::uint8_t candidates, Function& function)
+    {
+        if (candidates & (1u << Direction))
+        {
+            Neighbour neighbour = {
+                cell + Geometry::cellOffset(Direction),
+                cell * 4 + Geometry::edgeOffset(Direction),
+                Direction
+            };
+            if (function(neighbour))
+                return true;
+        }
+        return DirectionLoop <Geometry, Direction + 1>::until(cell, candidates, function);
+    }
+};
+
+template <typename Geometry>
+struct DirectionLoop <Geometry, DirectionCount>
+{
+    template <typename Function>
+    static inline bool until(CellIndex, std::uint8_t, Function&)
+    {
+        return false;
+    }
+};
+
+template <int Width, int Height>
+class StaticGeometry
+{
+public:
+    static_assert(Width * Height <= maxMatrixCells, "board is too large");
+
+    explicit StaticGeometry (NodeMatrix const& board)
+        : board_(&board)
+    {
+    }
+
+    static constexpr int getCellCount()
+    {
+        return Width * Height;
+    }
+
+    static constexpr int cellOffset(int direction)
+    {
+        return directionY[direction] * Width + directionX[direction];
+    }
+
+    // see EdgeIndex, the backwards directions use the edge owned by the neighbour.
+    static constexpr int edgeOffset(int direction)
+    {
+        return direction >= East
+            ? direction - East
+            : cellOffset(direction) * 4 + (oppositeDirection(direction) - East);
+    }
+
+    // south east of a cell crosses south west of its east neighbour.
+    static constexpr EdgeIndex getCrossingEdge(EdgeIndex edge)
+    {
+        return (edge & 3) == SouthEast - East
+            ? edge + 2
+            : (edge & 3) == SouthWest - East ? edge - 2 : -1;
+    }
+
+    // calls function for every neighbouring node not in excluded, until it returns true.
+    template <typename Function>
+    inline bool findNeighbour(CellIndex cell, std::uint8_t excluded, Function& function) const
+    {
+        auto candidates = static_cast <std::uint8_t> (board_->getNeighbourMask(cell) & ~excluded);
+        return DirectionLoop <StaticGeometry, 0>::until(cell, candidates, function);
+    }
+
+private:
+    NodeMatrix const* board_;
+};
+
+class DynamicGeometry
+{
+public:
+    explicit DynamicGeometry (NodeMatrix const& board)
+        : board_(&board)
+    {
+    }
+
+    inline int getCellCount() const
+    {
+        return board_->getCellCount();
+    }
+
+    inline EdgeIndex getCrossingEdge(EdgeIndex edge) const
+    {
+        return board_->getCrossingEdge(edge);
+    }
+
+    template <typename Function>
+    inline bool findNeighbour(CellIndex cell, std::uint8_t excluded, Function& function) const
+    {
+        for (auto const& neighbour : board_->getNeighbours(cell, excluded))
+            if (function(neighbour))
+                return true;
+        return false;
+    }
+
+private:
+    NodeMatrix const* board_;
+};
+
+/**
+ *  Calls function with the geometry matching the board, function needs a result_type.
+ *  The sizes below are the ones the game uses, everything else takes the table driven path.
+ */
+template <typename Function>
+typename Function::result_type withGeometry(NodeMatrix const& board, Function& function)
+{
+    auto width = board.getWidth();
+    auto height = board.getHeight();
+
+    if (width == 3 && height == 3)
+        return function(StaticGeometry <3, 3> {board});
+    if (width == 3 && height == 4)
+        return function(StaticGeometry <3, 4> {board});
+    if (width == 4 && height == 3)
+        return function(StaticGeometry <4, 3> {board});
+    if (width == 4 && height == 4)
+        return function(StaticGeometry <4, 4> {board});
+    if (width == 4 && height == 5)
+        return function(StaticGeometry <4, 5> {board});
+    if (width == 5 && height == 4)
+        return function(StaticGeometry <5, 4> {board});
+    if (width == 5 && height == 5)
+        return function(StaticGeometry <5, 5> {board});
+
+    return function(DynamicGeometry {board});
+}
+
+#endif // BOARD_GEOMETRY_H_INCLUDED
@@ -0,0 +1,50 @@
+#include "board_state.h"
+
+#include <random>
+
+BoardState::BoardState (NodeMatrix const& board)
+    : board_(&board)
+    , edges_()
+    , pending_()
+    , pendingByShape_(board.getShapeCount(), 0)
+    , pendingDegrees_(board.getCellCount(), 0)
+    , pendingCells_(0)
+    , edgeShapes_(board.getEdgeCount(), NodeShape::Nothing)
+    , edgeShapeIndices_(board.getEdgeCount(), -1)
+    , valences_(board.getCellCount(), 0)
+    , unsatisfied_(0)
+    , unsatisfiedByShape_(board.getShapeCount(), 0)
+    , openCells_(0)
+    , remainingByShape_(board.getShapeCount(), 0)
+    , remainingRestricted_(0)
+    , trail_()
+    , hash_(0)
+    , edgeKeys_(board.getEdgeCount() * board.getShapeCount())
+    , pendingKeys_(board.getEdgeCount())
+{
+    for (CellIndex cell = 0; cell != board.getCellCount(); ++cell)
+    {
+        if (board.getRequiredValence(cell) == 0)
+            continue;
+
+        openCells_ |= cellBit(cell);
+        ++unsatisfied_;
+        if (board.getShapeIndex(cell) != -1)
+        {
+            ++unsatisfiedByShape_[board.getShapeIndex(cell)];
+            remainingByShape_[board.getShapeIndex(cell)] += board.getRequiredValence(cell);
+        }
+        else
+            remainingRestricted_ += board.getRequiredValence(cell);
+    }
+
+    // every edge can be set and walked once at most, so the trail never grows beyond this.
+    trail_.reserve(2 * board.getEdgeCount());
+
+    // fixed seed, equal states of equal boards get equal hashes.
+    std::mt19937_64 random(0x4c594e45);
+    for (auto& key : edgeKeys_)
+        key = random();
+    for (auto& key : pendingKeys_)
+        key = random();
+}
@@ -0,0 +1,297 @@
+#ifndef BOARD_STATE_H_INCLUDED
+#define BOARD_STATE_H_INCLUDED
+
+#include "node_matrix.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ *  The mutable part of a game board. The NodeMatrix is shared and never touched,
+ *  every connection is recorded on a trail and can be undone by rewinding to a mark.
+ *
+ *  Edges deduced by propagation are "pending": they count towards the valences,
+ *  but the cursor of their shape still has to walk along them.
+ *
+ *  The state keeps a Zobrist hash of its edges, their shapes and which of them are pending.
+ */
+class BoardState
+{
+public:
+    using TrailMark = std::size_t;
+
+    explicit BoardState (NodeMatrix const& board);
+
+    inline NodeMatrix const& getBoard() const
+    {
+        return *board_;
+    }
+
+    inline int getValence(CellIndex cell) const
+    {
+        return valences_[cell];
+    }
+
+    inline int getRemainingValence(CellIndex cell) const
+    {
+        return board_->getRequiredValence(cell) - valences_[cell];
+    }
+
+    // O(1), nodes that still miss connections are counted on every change.
+    inline bool isSolved() const
+    {
+        return unsatisfied_ == 0;
+    }
+
+    inline bool isShapeSatisfied(int shapeIndex) const
+    {
+        return unsatisfiedByShape_[shapeIndex] == 0;
+    }
+
+    inline int getUnsatisfiedCount() const
+    {
+        return unsatisfied_;
+    }
+
+    inline int getUnsatisfiedCount(int shapeIndex) const
+    {
+        return unsatisfiedByShape_[shapeIndex];
+    }
+
+    // sum of the remaining valences of all nodes of the shape
+    inline int getRemainingValenceSum(int shapeIndex) const
+    {
+        return remainingByShape_[shapeIndex];
+    }
+
+    // sum of the remaining valences of all valence restricted nodes
+    inline int getRemainingRestrictedValence() const
+    {
+        return remainingRestricted_;
+    }
+
+    inline bool isConnected(EdgeIndex edge) const
+    {
+        return edges_.test(edge);
+    }
+
+    inline NodeShape getEdgeShape(EdgeIndex edge) const
+    {
+        return edgeShapes_[edge];
+    }
+
+    // -1 if the edge is not connected
+    inline int getEdgeShapeIndex(EdgeIndex edge) const
+    {
+        return edgeShapeIndices_[edge];
+    }
+
+    inline EdgeSet const& getEdges() const
+    {
+        return edges_;
+    }
+
+    inline std::uint64_t getHash() const
+    {
+        return hash_;
+    }
+
+    inline EdgeSet const& getPendingEdges() const
+    {
+        return pending_;
+    }
+
+    inline bool isPending(EdgeIndex edge) const
+    {
+        return pending_.test(edge);
+    }
+
+    inline int getPendingCount() const
+    {
+        return static_cast <int> (pending_.count());
+    }
+
+    inline int getPendingCount(int shapeIndex) const
+    {
+        return pendingByShape_[shapeIndex];
+    }
+
+    // nodes that still miss connections
+    inline CellMask getOpenCells() const
+    {
+        return openCells_;
+    }
+
+    // nodes with at least one pending edge
+    inline CellMask getPendingCells() const
+    {
+        return pendingCells_;
+    }
+
+    // shapes by their index in NodeMatrix::getShapeList()
+    inline void connect(EdgeIndex edge, int shapeIndex)
+    {
+        link(edge, shapeIndex);
+        trail_.push_back({edge, TrailEntry::Connect});
+    }
+
+    // connects an edge that has to be walked later.
+    inline void force(EdgeIndex edge, int shapeIndex)
+    {
+        link(edge, shapeIndex);
+        addPending(edge);
+        trail_.push_back({edge, TrailEntry::Force});
+    }
+
+    inline void walk(EdgeIndex edge)
+    {
+        removePending(edge);
+        trail_.push_back({edge, TrailEntry::Walk});
+    }
+
+    inline TrailMark mark() const
+    {
+        return trail_.size();
+    }
+
+    inline void undo(TrailMark mark)
+    {
+        while (trail_.size() > mark)
+        {
+            auto entry = trail_.back();
+            trail_.pop_back();
+
+            if (entry.kind == TrailEntry::Walk)
+            {
+                addPending(entry.edge);
+                continue;
+            }
+
+            if (entry.kind == TrailEntry::Force)
+                removePending(entry.edge);
+            unlink(entry.edge);
+        }
+    }
+
+private:
+    inline void link(EdgeIndex edge, int shapeIndex)
+    {
+        auto cells = board_->getEdgeCells(edge);
+        edges_.set(edge);
+        edgeShapes_[edge] = board_->getIndexedShape(shapeIndex);
+        edgeShapeIndices_[edge] = static_cast <std::int8_t> (shapeIndex);
+        hash_ ^= getEdgeKey(edge, shapeIndex);
+        addValence(cells.first);
+        addValence(cells.second);
+    }
+
+    inline void unlink(EdgeIndex edge)
+    {
+        auto cells = board_->getEdgeCells(edge);
+        hash_ ^= getEdgeKey(edge, edgeShapeIndices_[edge]);
+        edges_.reset(edge);
+        edgeShapes_[edge] = NodeShape::Nothing;
+        edgeShapeIndices_[edge] = -1;
+        removeValence(cells.first);
+        removeValence(cells.second);
+    }
+
+    inline void addPending(EdgeIndex edge)
+    {
+        auto cells = board_->getEdgeCells(edge);
+        pending_.set(edge);
+        hash_ ^= pendingKeys_[edge];
+        ++pendingByShape_[edgeShapeIndices_[edge]];
+        if (pendingDegrees_[cells.first]++ == 0)
+            pendingCells_ |= cellBit(cells.first);
+        if (pendingDegrees_[cells.second]++ == 0)
+            pendingCells_ |= cellBit(cells.second);
+    }
+
+    inline void removePending(EdgeIndex edge)
+    {
+        auto cells = board_->getEdgeCells(edge);
+        pending_.reset(edge);
+        hash_ ^= pendingKeys_[edge];
+        --pendingByShape_[edgeShapeIndices_[edge]];
+        if (--pendingDegrees_[cells.first] == 0)
+            pendingCells_ &= ~cellBit(cells.first);
+        if (--pendingDegrees_[cells.second] == 0)
+            pendingCells_ &= ~cellBit(cells.second);
+    }
+
+    inline std::uint64_t getEdgeKey(EdgeIndex edge, int shapeIndex) const
+    {
+        return edgeKeys_[edge * board_->getShapeCount() + shapeIndex];
+    }
+
+    inline void addValence(CellIndex cell)
+    {
+        if (board_->getShapeIndex(cell) != -1)
+            --remainingByShape_[board_->getShapeIndex(cell)];
+        else
+            --remainingRestricted_;
+
+        if (++valences_[cell] == board_->getRequiredValence(cell))
+        {
+            openCells_ &= ~cellBit(cell);
+            --unsatisfied_;
+            if (board_->getShapeIndex(cell) != -1)
+                --unsatisfiedByShape_[board_->getShapeIndex(cell)];
+        }
+    }
+
+    inline void removeValence(CellIndex cell)
+    {
+        if (board_->getShapeIndex(cell) != -1)
+            ++remainingByShape_[board_->getShapeIndex(cell)];
+        else
+            ++remainingRestricted_;
+
+        if (valences_[cell]-- == board_->getRequiredValence(cell))
+        {
+            openCells_ |= cellBit(cell);
+            ++unsatisfied_;
+            if (board_->getShapeIndex(cell) != -1)
+                ++unsatisfiedByShape_[board_->getShapeIndex(cell)];
+        }
+    }
+
+private:
+    struct TrailEntry
+    {
+        enum Kind : std::uint8_t
+        {
+            Connect,
+            Force,
+            Walk
+        };
+
+        EdgeIndex edge;
+        Kind kind;
+    };
+
+    NodeMatrix const* board_;
+
+    EdgeSet edges_;
+    EdgeSet pending_;
+    std::vector <int> pendingByShape_;
+    std::vector <std::uint8_t> pendingDegrees_;
+    CellMask pendingCells_;
+    std::vector <NodeShape> edgeShapes_;
+    std::vector <std::int8_t> edgeShapeIndices_;
+    std::vector <std::uint8_t> valences_;
+    int unsatisfied_;
+    std::vector <int> unsatisfiedByShape_;
+    CellMask openCells_;
+    std::vector <int> remainingByShape_;
+    int remainingRestricted_;
+
+    std::vector <TrailEntry> trail_;
+
+    std::uint64_t hash_;
+    std::vector <std::uint64_t> edgeKeys_; // per edge and shape index
+    std::vector <std::uint64_t> pendingKeys_;
+};
+
+#endif // BOARD_STATE_H_INCLUDED
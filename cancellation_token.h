@@ -0,0 +1,39 @@
+#ifndef CANCELLATION_TOKEN_H_INCLUDED
+#define CANCELLATION_TOKEN_H_INCLUDED
+
+#include <atomic>
+#include <memory>
+
+/**
+ *  Lets another thread stop a solve. Copies share their state, so the caller keeps one copy
+ *  and hands another to the solver with the SolveOptions. The searches only read a flag.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken ()
+        : cancelled_(std::make_shared <std::atomic <bool> > (false))
+    {
+    }
+
+    void cancel()
+    {
+        cancelled_->store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelled() const
+    {
+        return cancelled_->load(std::memory_order_relaxed);
+    }
+
+    // stays valid as long as a copy of the token lives
+    std::atomic <bool> const* getFlag() const
+    {
+        return cancelled_.get();
+    }
+
+private:
+    std::shared_ptr <std::atomic <bool> > cancelled_;
+};
+
+#endif // CANCELLATION_TOKEN_H_INCLUDED
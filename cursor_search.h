@@ -0,0 +1,999 @@
+#ifndef CURSOR_SEARCH_H_INCLUDED
+#define CURSOR_SEARCH_H_INCLUDED
+
+#include "board_geometry.h"
+#include "board_state.h"
+#include "hamiltonian_oracle.h"
+#include "matrix_cursor.h"
+#include "move_ordering.h"
+#include "nogood_store.h"
+#include "path.h"
+#include "path_bounds.h"
+#include "propagation.h"
+#include "reachability.h"
+#include "solve_budget.h"
+#include "solve_options.h"
+#include "solve_statistics.h"
+#include "transposition_table.h"
+
+#include <atomic>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/**
+ *  The backtracking search of the LYNESolver, one cursor per shape.
+ *  Instantiated per Geometry, so the step/connect/check routines get specialised
+ *  for the common board sizes.
+ *
+ *  With backjumping every edge remembers the decisions it depends on. A failed step is
+ *  explained by the edges around the cells its checks looked at, a dead end jumps back to
+ *  the latest decision of its explanation and learns the combination as a nogood.
+ *
+ *  States proven to fail are remembered by their hash: the edges of the BoardState
+ *  and where the cursors stand.
+ *
+ *  For parallel searches the tree can be cut into subtrees: with a split depth the search
+ *  collects the steps leading to every node of that depth instead of going deeper, with
+ *  a prefix it takes those steps first and only searches below them.
+ */
+template <typename Geometry>
+class CursorSearch
+{
+public:
+    CursorSearch (NodeMatrix const& board, Geometry geometry, SolveOptions const& options, long long& stepCounter, long long& backtrackCounter,
+                  SolveStatistics& statistics, HamiltonianOracle const* oracle = nullptr);
+
+    // charges the budget with the last steps
+    ~CursorSearch ();
+
+    // the cursor and the direction of each step
+    using Prefix = std::vector <std::pair <int, int> >;
+    using SolutionCallback = std::function <bool (std::vector <NodePath> const&, std::uint64_t)>;
+
+    std::vector <NodePath> run();
+
+    // turns backjumping and the transposition table off
+    void setSplitDepth(int depth, std::vector <Prefix>* prefixes);
+    void setPrefix(Prefix const& prefix);
+
+    // checked before every step, run() returns nothing once it is set
+    void setCancelFlag(std::atomic <bool> const* cancel);
+
+    // run() returns nothing after that many steps, -1 for no limit
+    void setStepLimit(long long steps);
+
+    // checked like the cancel flag, the steps from now on are charged to it. The search also
+    // remembers its deepest state and hands it to the budget when it stops.
+    void setBudget(SolveBudget* budget);
+
+    // called for every solution with the hash of its edges, the search carries on while it returns true.
+    // Once it is exhausted run() throws as if there was no solution.
+    void setSolutionCallback(SolutionCallback const& onSolution);
+
+    // by the cancel flag, the step limit or the budget
+    bool isCancelled() const;
+
+private:
+    inline bool canConnect(CellIndex cell, Neighbour const& neighbour, NodeShape type) const;
+    inline bool makeStep(MatrixCursor& cursor);
+    inline bool backtrack(MatrixCursor& cursor);
+    inline void followPartner(MatrixCursor const& cursor);
+    void pushDecision(int active);
+    int selectCursor();
+    int selectLoop(int first) const;
+
+    inline bool couldCompleteShapes(MatrixCursor const& cursor, CellIndex position);
+    std::vector <NodePath> getPathes() const;
+
+    // a split charges none, the searches below it walk its levels again
+    inline long long getUnchargedSteps() const
+    {
+        return splitDepth_ == -1 ? stepCounter_ - chargedStep_ : 0;
+    }
+    inline bool couldCoverShape(MatrixCursor const& cursor, CellIndex position) const;
+
+    // backjumping
+    LevelSet explainCells(CellMask cells) const;
+    LevelSet explainCursor(int index) const;
+    LevelSet explainShape(int index) const;
+    LevelSet explainFinished() const;
+    void explainForced(CellMask visited, EdgeSet const& pendingBefore);
+    bool isNogood(int index, EdgeIndex edge, CellIndex position, LevelSet& reasons) const;
+    void learnNogood(LevelSet const& conflict);
+    int jumpBack(LevelSet conflict);
+
+    inline void addConflict(LevelSet const& reasons)
+    {
+        conflicts_[decisions_.size()] |= reasons;
+    }
+
+    // transpositions
+    std::uint64_t getStateHash(int index, CellIndex position) const;
+    bool isKnownFailure(int index, CellIndex position);
+    void recordFailure();
+
+    inline int getCursorIndex(MatrixCursor const& cursor) const
+    {
+        return static_cast <int> (&cursor - cursors_.data());
+    }
+
+    inline bool isSolution() const
+    {
+        return state_.isSolved() && state_.getPendingCount() == 0;
+    }
+
+    // every node of the shape is connected and the cursor walked all deduced edges.
+    inline bool couldBeShapeSolution(int shapeIndex) const
+    {
+        return state_.isShapeSatisfied(shapeIndex) && state_.getPendingCount(shapeIndex) == 0;
+    }
+
+    inline bool isFinished(MatrixCursor const& cursor) const
+    {
+        return hasReachedTarget(cursor) && couldBeShapeSolution(cursor.shapeIndex);
+    }
+
+    // finished fronts that met on a valence restricted node may still walk a loop through it,
+    // out and back in. The front of the pair with the lower index walks it.
+    inline bool couldLoop(int index) const
+    {
+        auto const& cursor = cursors_[index];
+        return cursor.partner > index && isFinished(cursor) && state_.getRemainingValence(cursor.position()) >= 2;
+    }
+
+    // the target and every open node of the shape are still in reach, with enough moves left.
+    // Otherwise failedCells_ tells which cells the failure depends on.
+    inline bool couldCompleteShape(int shapeIndex, CellIndex position, CellIndex target)
+    {
+        if (!canReachShape(state_, shapeIndex, position, target, &failedCells_))
+            return false;
+        if (isWithinPathBounds(state_, shapeIndex, position, target))
+            return true;
+
+        // the bounds count the valences of the whole shape and of all valence restricted nodes.
+        failedCells_ = board_.getShapeCells(shapeIndex) | board_.getValenceRestrictedCells() | board_.growCells(cellBit(position));
+        return false;
+    }
+
+private:
+    NodeMatrix const& board_;
+    Geometry geometry_;
+    BoardState state_;
+    std::vector <MatrixCursor> cursors_;
+    MoveOrderer orderer_;
+    HamiltonianOracle const* oracle_; // shared with other searches on the board, may be null
+    ShapeOrdering shapeOrdering_;
+    std::vector <int> decisions_; // the cursor that made each step, oldest first
+    std::vector <EdgeIndex> decisionEdges_;
+
+    bool backjumping_;
+    std::vector <LevelSet> edgeReasons_; // decisions a connected edge depends on
+    std::vector <LevelSet> cursorLevels_; // decisions that moved each cursor
+    std::vector <LevelSet> conflicts_; // per level, the decisions the failed steps there depend on
+    NogoodStore nogoods_;
+    int failedCursor_; // cursor that could not be completed by the last check
+    CellMask failedCells_;
+
+    TranspositionTable transpositions_;
+    std::vector <std::uint64_t> headKeys_; // per cursor and cell
+    std::vector <long long> levelSteps_; // step counter when each level was entered
+
+    int splitDepth_; // -1 if the search goes all the way
+    std::vector <Prefix>* prefixes_;
+    Prefix prefix_;
+    int floor_; // levels of the prefix, the search never takes them back
+    std::atomic <bool> const* cancel_;
+    long long stepLimit_;
+    bool cancelled_;
+    SolveBudget* budget_;
+    long long chargedStep_; // the step counter when the budget was last charged
+    std::size_t deepest_; // steps of the deepest state, kept only with a budget
+    std::vector <NodePath> deepestPathes_;
+    SolutionCallback onSolution_;
+
+    long long& stepCounter_;
+    long long& backtrackCounter_;
+    SolveStatistics& statistics_;
+};
+
+template <typename Geometry>
+CursorSearch <Geometry>::CursorSearch (NodeMatrix const& board, Geometry geometry, SolveOptions const& options, long long& stepCounter, long long& backtrackCounter,
+                                       SolveStatistics& statistics, HamiltonianOracle const* oracle)
+    : board_(board)
+    , geometry_(geometry)
+    , state_(board)
+    , cursors_()
+    , orderer_(options.ordering, options.seed)
+    , oracle_(oracle)
+    , shapeOrdering_(options.shapeOrdering)
+    , decisions_()
+    , decisionEdges_()
+    , backjumping_(options.backjumping)
+    , edgeReasons_(board.getEdgeCount())
+    , cursorLevels_()
+    , conflicts_(maxMatrixEdges + 1)
+    , nogoods_(options.nogoodCapacity)
+    , failedCursor_(-1)
+    , failedCells_(0)
+    , transpositions_(options.transpositionTableBytes)
+    , headKeys_()
+    , levelSteps_(maxMatrixEdges + 1, 0)
+    , splitDepth_(-1)
+    , prefixes_(nullptr)
+    , prefix_()
+    , floor_(0)
+    , cancel_(nullptr)
+    , stepLimit_(-1)
+    , cancelled_(false)
+    , budget_(nullptr)
+    , chargedStep_(0)
+    , deepest_(0)
+    , deepestPathes_()
+    , onSolution_()
+    , stepCounter_(stepCounter)
+    , backtrackCounter_(backtrackCounter)
+    , statistics_(statistics)
+{
+    // make the cursors for each shape
+    auto shapes = board.getShapeList();
+    cursors_.reserve(options.bidirectional ? 2 * shapes.size() : shapes.size());
+
+    for (auto const& i : shapes)
+    {
+        boost::optional <std::pair <MatrixPosition, MatrixPosition> > endpoints = board.getStartEndPair(i);
+        if (!endpoints)
+            throw std::runtime_error("board is invalid");
+
+        auto start = board.getIndex(endpoints.get().first);
+        auto target = board.getIndex(endpoints.get().second);
+        auto shapeIndex = board.getShapeIndex(i);
+        cursors_.emplace_back (start, target, i, shapeIndex);
+
+        // the second front starts at the target and the two chase each other.
+        if (options.bidirectional)
+        {
+            auto front = static_cast <int> (cursors_.size()) - 1;
+            cursors_.emplace_back (target, start, i, shapeIndex);
+            cursors_[front].partner = front + 1;
+            cursors_[front + 1].partner = front;
+        }
+    }
+
+    decisions_.reserve(maxMatrixEdges);
+    decisionEdges_.reserve(maxMatrixEdges);
+    cursorLevels_.resize(cursors_.size());
+
+    std::mt19937_64 random(0x435552);
+    headKeys_.resize(cursors_.size() * board.getCellCount());
+    for (auto& key : headKeys_)
+        key = random();
+}
+
+template <typename Geometry>
+CursorSearch <Geometry>::~CursorSearch ()
+{
+    if (budget_ != nullptr)
+        budget_->charge(getUnchargedSteps());
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::canConnect(CellIndex cell, Neighbour const& neighbour, NodeShape type) const
+{
+    // Check for max valence
+    if (state_.getRemainingValence(cell) == 0 || state_.getRemainingValence(neighbour.cell) == 0)
+        return false;
+
+    // Existing connection check
+    if (state_.isConnected(neighbour.edge))
+        return false;
+
+    // Check for diagonal block
+    auto crossing = geometry_.getCrossingEdge(neighbour.edge);
+    if (crossing != -1 && state_.isConnected(crossing))
+        return false;
+
+    // Check for correct color
+    auto shape1 = board_.getShape(cell);
+    auto shape2 = board_.getShape(neighbour.cell);
+    if ((shape1 != type && shape1 != NodeShape::ValenceRestricted) ||
+        (shape2 != type && shape2 != NodeShape::ValenceRestricted))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::couldCompleteShapes(MatrixCursor const& cursor, CellIndex position)
+{
+    if (position != cursor.target && !couldCompleteShape(cursor.shapeIndex, position, cursor.target))
+    {
+        failedCursor_ = getCursorIndex(cursor);
+        return false;
+    }
+
+    // only depends on where the path went.
+    if (position != cursor.target && !couldCoverShape(cursor, position))
+    {
+        failedCursor_ = getCursorIndex(cursor);
+        failedCells_ = 0;
+        return false;
+    }
+
+    // the step may also have cut off one of the other shapes. The partner covers the same path.
+    for (auto const& i : cursors_)
+    {
+        if (&i == &cursor || (cursor.partner != -1 && &i == &cursors_[cursor.partner]) || hasReachedTarget(i))
+            continue;
+        if (!couldCompleteShape(i.shapeIndex, i.position(), i.target))
+        {
+            failedCursor_ = getCursorIndex(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::couldCoverShape(MatrixCursor const& cursor, CellIndex position) const
+{
+    // the table is about the whole path, the front of a partner only grows a part of it.
+    if (oracle_ == nullptr || cursor.partner != -1)
+        return true;
+    return oracle_->canComplete(cursor.shapeIndex, getVisitedCells(cursor) | cellBit(position), position);
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::makeStep(MatrixCursor& cursor)
+{
+    struct TryStep
+    {
+        CursorSearch& search;
+        MatrixCursor& cursor;
+
+        inline bool operator()(Neighbour const& next)
+        {
+            cursor.tried[cursor.depth] |= static_cast <std::uint8_t> (1u << next.direction);
+
+            auto& state = search.state_;
+            auto const& board = search.board_;
+            auto backjumping = search.backjumping_;
+            auto index = search.getCursorIndex(cursor);
+            auto around = board.growCells(cellBit(cursor.position()) | cellBit(next.cell));
+
+            // the step depends on the path that lead to its cell
+            auto reasons = search.cursorLevels_[index];
+            reasons.set(search.decisions_.size());
+
+            auto mark = state.mark();
+            CellMask visited = 0;
+            if (state.isPending(next.edge))
+            {
+                // deduced earlier, the cursor only has to follow it.
+                if (state.getEdgeShape(next.edge) != cursor.shape)
+                {
+                    if (backjumping)
+                        search.addConflict(search.explainCells(around));
+                    return false;
+                }
+                state.walk(next.edge);
+                search.edgeReasons_[next.edge] |= reasons;
+            }
+            else
+            {
+                if (!search.canConnect(cursor.position(), next, cursor.shape))
+                {
+                    if (backjumping)
+                        search.addConflict(search.explainCells(around));
+                    return false;
+                }
+
+                state.connect(next.edge, cursor.shapeIndex);
+                search.edgeReasons_[next.edge] = reasons;
+
+                auto pendingBefore = state.getPendingEdges();
+                auto consistent = propagate(state, getAffectedCells(board, next.edge), &visited);
+                if (backjumping)
+                    search.explainForced(visited, pendingBefore);
+                if (!consistent)
+                {
+                    if (backjumping)
+                        search.addConflict(search.explainCells(around | board.growCells(visited)));
+                    state.undo(mark);
+                    return false;
+                }
+            }
+
+            if (!search.couldCompleteShapes(cursor, next.cell))
+            {
+                if (backjumping)
+                    search.addConflict(search.explainCursor(search.failedCursor_) | search.explainCells(search.failedCells_ | around));
+                state.undo(mark);
+                return false;
+            }
+
+            LevelSet nogoodReasons;
+            if (backjumping && search.isNogood(index, next.edge, next.cell, nogoodReasons))
+            {
+                search.addConflict(nogoodReasons);
+                state.undo(mark);
+                return false;
+            }
+
+            // nothing is known about why the state failed, so it depends on every decision.
+            if (search.isKnownFailure(index, next.cell))
+            {
+                if (backjumping)
+                    search.addConflict(~LevelSet() >> (maxMatrixEdges - search.decisions_.size()));
+                state.undo(mark);
+                return false;
+            }
+
+            search.stepCounter_++;
+            decendCursor(cursor, next.cell, mark);
+            search.followPartner(cursor);
+            return true;
+        }
+    } tryStep{*this, cursor};
+
+    if (orderer_.getOrdering() == MoveOrdering::Fixed)
+        return geometry_.findNeighbour(cursor.position(), cursor.tried[cursor.depth], tryStep);
+
+    // score the untried candidates, then try them best first. Ties keep the direction order.
+    struct ScoreStep
+    {
+        CursorSearch& search;
+        MatrixCursor& cursor;
+        Neighbour candidates[DirectionCount];
+        int scores[DirectionCount];
+        int count;
+
+        inline bool operator()(Neighbour const& next)
+        {
+            auto score = search.orderer_.score(search.state_, cursor, next);
+
+            int i = count++;
+            for (; i != 0 && scores[i - 1] > score; --i)
+            {
+                candidates[i] = candidates[i - 1];
+                scores[i] = scores[i - 1];
+            }
+            candidates[i] = next;
+            scores[i] = score;
+            return false;
+        }
+    } scoreStep{*this, cursor, {}, {}, 0};
+
+    geometry_.findNeighbour(cursor.position(), cursor.tried[cursor.depth], scoreStep);
+    for (int i = 0; i != scoreStep.count; ++i)
+        if (tryStep(scoreStep.candidates[i]))
+            return true;
+    return false;
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::backtrack(MatrixCursor& cursor)
+{
+    backtrackCounter_++;
+
+    if (cursor.depth == 0)
+        return false;
+    state_.undo(cursor.marks[cursor.depth]);
+    auto result = backtrackCursor(cursor);
+    followPartner(cursor);
+    return result;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::followPartner(MatrixCursor const& cursor)
+{
+    if (cursor.partner != -1)
+        cursors_[cursor.partner].target = cursor.position();
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::pushDecision(int active)
+{
+    auto const& cursor = cursors_[active];
+    cursorLevels_[active].set(decisions_.size());
+    decisions_.push_back(active);
+    decisionEdges_.push_back(board_.getEdge(
+        board_.getMatrixPosition(cursor.path[cursor.depth - 1]),
+        board_.getMatrixPosition(cursor.path[cursor.depth])
+    ));
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::setSplitDepth(int depth, std::vector <Prefix>* prefixes)
+{
+    // the nodes at the depth are not dead ends, nothing may be learned from leaving them.
+    backjumping_ = false;
+    transpositions_ = TranspositionTable(0);
+    splitDepth_ = depth;
+    prefixes_ = prefixes;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::setPrefix(Prefix const& prefix)
+{
+    prefix_ = prefix;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::setCancelFlag(std::atomic <bool> const* cancel)
+{
+    cancel_ = cancel;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::setStepLimit(long long steps)
+{
+    stepLimit_ = steps;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::setBudget(SolveBudget* budget)
+{
+    budget_ = budget;
+    chargedStep_ = stepCounter_;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::setSolutionCallback(SolutionCallback const& onSolution)
+{
+    onSolution_ = onSolution;
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::isCancelled() const
+{
+    return cancelled_;
+}
+
+template <typename Geometry>
+int CursorSearch <Geometry>::selectCursor()
+{
+    // stays -1 if every cursor is finished
+    failedCursor_ = -1;
+
+    // keep going with the shape of the last step until it is done, unless interleaving.
+    if (shapeOrdering_ == ShapeOrdering::MostConstrained && !decisions_.empty())
+    {
+        auto last = decisions_.back();
+        auto const& cursor = cursors_[last];
+        if (cursor.partner == -1 && !hasReachedTarget(cursor))
+            return last;
+
+        // of both fronts, the one with fewer options moves.
+        if (cursor.partner != -1 && !isFinished(cursor))
+        {
+            auto options = countOnwardOptions(state_, cursor.position(), cursor.shape, -1);
+            auto partnerOptions = countOnwardOptions(state_, cursors_[cursor.partner].position(), cursor.shape, -1);
+            if (options == 0 || partnerOptions == 0)
+            {
+                failedCursor_ = options == 0 ? last : cursor.partner;
+                return -1;
+            }
+            return options <= partnerOptions ? last : cursor.partner;
+        }
+    }
+
+    int best = -1;
+    int bestOptions = 0;
+    int bestOpenCells = 0;
+    for (int i = 0; i != static_cast <int> (cursors_.size()); ++i)
+    {
+        auto const& cursor = cursors_[i];
+        if (isFinished(cursor))
+            continue;
+
+        // a path ends at its target, the rest of the shape can not be reached anymore.
+        // Fronts may meet on a valence restricted node and carry on.
+        if (hasReachedTarget(cursor) && cursor.partner == -1)
+        {
+            failedCursor_ = i;
+            return -1;
+        }
+
+        if (shapeOrdering_ == ShapeOrdering::Sequential)
+            return i;
+
+        auto options = countOnwardOptions(state_, cursor.position(), cursor.shape, -1);
+        if (options == 0)
+        {
+            failedCursor_ = i;
+            return -1;
+        }
+
+        auto openCells = state_.getUnsatisfiedCount(cursor.shapeIndex);
+        if (best == -1 || options < bestOptions || (options == bestOptions && openCells < bestOpenCells))
+        {
+            best = i;
+            bestOptions = options;
+            bestOpenCells = openCells;
+        }
+    }
+
+    // every cursor is finished, but the board is not solved yet.
+    return best != -1 ? best : selectLoop(0);
+}
+
+template <typename Geometry>
+int CursorSearch <Geometry>::selectLoop(int first) const
+{
+    for (int i = first; i < static_cast <int> (cursors_.size()); ++i)
+    {
+        if (couldLoop(i))
+            return i;
+    }
+    return -1;
+}
+
+template <typename Geometry>
+LevelSet CursorSearch <Geometry>::explainCells(CellMask cells) const
+{
+    LevelSet reasons;
+    while (cells)
+    {
+        for (auto const& neighbour : board_.getNeighbours(popCell(cells)))
+            if (state_.isConnected(neighbour.edge))
+                reasons |= edgeReasons_[neighbour.edge];
+    }
+    return reasons;
+}
+
+template <typename Geometry>
+LevelSet CursorSearch <Geometry>::explainCursor(int index) const
+{
+    // where a cursor stands depends on all of its steps, for fronts also on where the partner stands.
+    auto reasons = cursorLevels_[index];
+    if (cursors_[index].partner != -1)
+        reasons |= cursorLevels_[cursors_[index].partner];
+    return reasons;
+}
+
+template <typename Geometry>
+LevelSet CursorSearch <Geometry>::explainShape(int index) const
+{
+    // the completion checks look at the nodes of the shape and at every valence restricted node.
+    auto const& cursor = cursors_[index];
+    auto cells = board_.getShapeCells(cursor.shapeIndex) | board_.getValenceRestrictedCells() |
+                 board_.growCells(cellBit(cursor.position()));
+    return explainCursor(index) | explainCells(cells);
+}
+
+template <typename Geometry>
+LevelSet CursorSearch <Geometry>::explainFinished() const
+{
+    // every cursor stands where it is finished, with every node of its shape connected,
+    // but some valence restricted node is still open.
+    auto reasons = explainCells(board_.getNodeCells());
+    for (int i = 0; i != static_cast <int> (cursors_.size()); ++i)
+        reasons |= explainCursor(i);
+    return reasons;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::explainForced(CellMask visited, EdgeSet const& pendingBefore)
+{
+    // deductions only force edges of visited cells and only look at the cells around them.
+    EdgeSet forced;
+    for (auto cells = visited; cells; )
+    {
+        for (auto const& neighbour : board_.getNeighbours(popCell(cells)))
+            if (state_.isPending(neighbour.edge) && !pendingBefore.test(neighbour.edge))
+            {
+                forced.set(neighbour.edge);
+                edgeReasons_[neighbour.edge].reset();
+            }
+    }
+    if (forced.none())
+        return;
+
+    auto reasons = explainCells(board_.growCells(visited));
+    for (auto cells = visited; cells; )
+    {
+        for (auto const& neighbour : board_.getNeighbours(popCell(cells)))
+            if (forced.test(neighbour.edge))
+                edgeReasons_[neighbour.edge] = reasons;
+    }
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::isNogood(int index, EdgeIndex edge, CellIndex position, LevelSet& reasons) const
+{
+    auto const& candidates = nogoods_.getCandidates(edge);
+    if (candidates.empty())
+        return false;
+
+    auto walked = state_.getEdges() & ~state_.getPendingEdges();
+    for (auto candidate : candidates)
+    {
+        auto const& nogood = nogoods_.get(candidate);
+        if ((nogood.edgeSet & ~walked).any())
+            continue;
+
+        bool matches = true;
+        for (auto iter = std::begin(nogood.heads); matches && iter != std::end(nogood.heads); ++iter)
+        {
+            auto const& cursor = cursors_[iter->cursor];
+            if (iter->cursor == index)
+                matches = position == iter->position && cursor.depth + 1 == iter->depth;
+            else
+                matches = cursor.position() == iter->position && cursor.depth == iter->depth;
+        }
+        for (auto iter = std::begin(nogood.edges); matches && iter != std::end(nogood.edges); ++iter)
+            matches = state_.getEdgeShape(iter->first) == iter->second;
+        if (!matches)
+            continue;
+
+        for (auto const& i : nogood.edges)
+            reasons |= edgeReasons_[i.first];
+        for (auto const& i : nogood.heads)
+            reasons |= explainCursor(i.cursor);
+        return true;
+    }
+    return false;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::learnNogood(LevelSet const& conflict)
+{
+    // long nogoods hardly ever come back and are slow to check.
+    constexpr std::size_t maxNogoodSize = 32;
+    if (nogoods_.getCapacity() == 0 || conflict.count() > maxNogoodSize)
+        return;
+
+    Nogood nogood;
+    for (std::size_t level = 0; level != decisions_.size(); ++level)
+    {
+        if (!conflict.test(level))
+            continue;
+
+        auto edge = decisionEdges_[level];
+        nogood.edges.emplace_back(edge, state_.getEdgeShape(edge));
+
+        // the cursors are still where the conflict found them
+        auto cursor = decisions_[level];
+        auto later = cursorLevels_[cursor] >> (level + 1);
+        if (later.none())
+            nogood.heads.push_back({cursor, cursors_[cursor].position(), cursors_[cursor].depth});
+    }
+    nogoods_.add(std::move(nogood));
+}
+
+template <typename Geometry>
+std::uint64_t CursorSearch <Geometry>::getStateHash(int index, CellIndex position) const
+{
+    // the cursor at index is about to stand on position
+    auto hash = state_.getHash();
+    for (int i = 0; i != static_cast <int> (cursors_.size()); ++i)
+        hash ^= headKeys_[i * board_.getCellCount() + (i == index ? position : cursors_[i].position())];
+    return hash;
+}
+
+template <typename Geometry>
+bool CursorSearch <Geometry>::isKnownFailure(int index, CellIndex position)
+{
+    if (!transpositions_.isEnabled())
+        return false;
+
+    if (transpositions_.contains(getStateHash(index, position)))
+    {
+        ++statistics_.transpositionHits;
+        return true;
+    }
+    ++statistics_.transpositionMisses;
+    return false;
+}
+
+template <typename Geometry>
+void CursorSearch <Geometry>::recordFailure()
+{
+    if (transpositions_.isEnabled())
+        transpositions_.insert(getStateHash(-1, -1), stepCounter_ - levelSteps_[decisions_.size()]);
+}
+
+template <typename Geometry>
+int CursorSearch <Geometry>::jumpBack(LevelSet conflict)
+{
+    auto level = static_cast <int> (decisions_.size());
+
+    // chronological backtracking takes back the last decision, backjumping the last one that matters.
+    auto target = level - 1;
+    if (backjumping_)
+    {
+        while (target >= 0 && !conflict.test(target))
+            --target;
+        if (target >= 0)
+        {
+            conflict &= ~LevelSet() >> (maxMatrixEdges - target - 1);
+            learnNogood(conflict);
+        }
+    }
+    if (target < floor_)
+        throw std::runtime_error("No solution");
+
+    // this node and every node jumped over fail no matter what comes after them.
+    recordFailure();
+
+    int cursor = -1;
+    while (static_cast <int> (decisions_.size()) > target)
+    {
+        cursor = decisions_.back();
+        cursorLevels_[cursor].reset(decisions_.size() - 1);
+        decisions_.pop_back();
+        decisionEdges_.pop_back();
+        backtrack(cursors_[cursor]);
+
+        if (static_cast <int> (decisions_.size()) > target)
+            recordFailure();
+    }
+
+    // the failure of the taken back step is part of the reasons its node fails.
+    conflict.reset(target);
+    conflicts_[target] |= conflict;
+    return cursor;
+}
+
+template <typename Geometry>
+std::vector <NodePath> CursorSearch <Geometry>::run()
+{
+    // deductions that hold for the empty board
+    if (!propagate(state_, board_.getNodeCells()))
+        throw std::runtime_error("No solution");
+    for (auto const& i : cursors_)
+    {
+        if (!couldCoverShape(i, i.start))
+            throw std::runtime_error("No solution");
+    }
+
+    // the steps of the prefix allow nothing else
+    for (auto const& i : prefix_)
+    {
+        conflicts_[decisions_.size()].reset();
+        levelSteps_[decisions_.size()] = stepCounter_;
+        auto& cursor = cursors_[i.first];
+        cursor.tried[cursor.depth] = static_cast <std::uint8_t> (~(1u << i.second));
+        if (!makeStep(cursor))
+            throw std::runtime_error("No solution");
+        pushDecision(i.first);
+    }
+    floor_ = static_cast <int> (decisions_.size());
+    auto firstStep = stepCounter_;
+    chargedStep_ = stepCounter_; // the split charged the prefix already
+
+    // solve puzzle: every step is a decision of one cursor. A search node branches over the
+    // steps of a single cursor, which is complete because every unfinished cursor has to move on.
+    bool entered = true;
+    int active = -1;
+    for (;;)
+    {
+        if (budget_ != nullptr && stepCounter_ - chargedStep_ >= SolveBudget::chargeInterval)
+        {
+            budget_->charge(getUnchargedSteps());
+            chargedStep_ = stepCounter_;
+        }
+
+        if ((cancel_ != nullptr && cancel_->load(std::memory_order_relaxed)) || (stepLimit_ != -1 && stepCounter_ - firstStep >= stepLimit_)
+            || (budget_ != nullptr && budget_->isExhausted(getUnchargedSteps())))
+        {
+            if (budget_ != nullptr && !deepestPathes_.empty())
+                budget_->offerPartial(deepestPathes_, deepest_);
+            cancelled_ = true;
+            return {};
+        }
+
+        if (entered)
+        {
+            // when enumerating, a solution counts as a dead end that depends on every decision.
+            if (isSolution())
+            {
+                if (!onSolution_ || !onSolution_(getPathes(), state_.getHash()))
+                    break;
+
+                active = jumpBack(~LevelSet() >> (maxMatrixEdges - decisions_.size()));
+                entered = false;
+                continue;
+            }
+
+            conflicts_[decisions_.size()].reset();
+            levelSteps_[decisions_.size()] = stepCounter_;
+
+            // leave the subtree to whoever gets the prefix
+            if (static_cast <int> (decisions_.size()) == splitDepth_)
+            {
+                // the decisions of a cursor are the steps along its path
+                Prefix prefix;
+                std::vector <int> depths(cursors_.size(), 0);
+                for (auto i : decisions_)
+                {
+                    auto const& cursor = cursors_[i];
+                    auto from = board_.getMatrixPosition(cursor.path[depths[i]]);
+                    auto to = board_.getMatrixPosition(cursor.path[++depths[i]]);
+                    prefix.emplace_back(i, directionFromOffset(to.x - from.x, to.y - from.y));
+                }
+                prefixes_->push_back(prefix);
+
+                active = jumpBack(LevelSet());
+                entered = false;
+                continue;
+            }
+
+            active = selectCursor();
+            if (active != -1)
+                cursors_[active].tried[cursors_[active].depth] = 0;
+        }
+
+        if (active != -1 && makeStep(cursors_[active]))
+        {
+            pushDecision(active);
+            if (budget_ != nullptr && decisions_.size() > deepest_)
+            {
+                deepest_ = decisions_.size();
+                deepestPathes_ = getPathes();
+            }
+            entered = true;
+            continue;
+        }
+
+        // no loop of these fronts works, so they close their path and the next pair has to loop.
+        if (active != -1 && isFinished(cursors_[active]))
+        {
+            auto next = selectLoop(active + 1);
+            if (next != -1)
+            {
+                active = next;
+                cursors_[active].tried[cursors_[active].depth] = 0;
+                entered = false;
+                continue;
+            }
+        }
+
+        // dead end, no step of the cursor works or some cursor is stuck.
+        LevelSet conflict;
+        if (backjumping_ && active == -1)
+            conflict = failedCursor_ != -1 ? explainShape(failedCursor_) : explainFinished();
+        else if (backjumping_ && isFinished(cursors_[active]))
+            conflict = conflicts_[decisions_.size()] | explainFinished();
+        else if (backjumping_)
+            conflict = conflicts_[decisions_.size()] | explainCursor(active);
+
+        active = jumpBack(conflict);
+        entered = false;
+    }
+
+    return getPathes();
+}
+
+template <typename Geometry>
+std::vector <NodePath> CursorSearch <Geometry>::getPathes() const
+{
+    // paths are reported from the target back to the start
+    std::vector <NodePath> pathes;
+    for (int i = 0; i != static_cast <int> (cursors_.size()); ++i)
+    {
+        auto const& cursor = cursors_[i];
+        if (cursor.partner != -1 && cursor.partner < i)
+            continue;
+
+        NodePath path;
+        if (cursor.partner != -1)
+        {
+            // both fronts end on the same cell
+            auto const& back = cursors_[cursor.partner];
+            for (int depth = 0; depth < back.depth; ++depth)
+                path.push_back(board_.getPixelPosition(back.path[depth]));
+        }
+        for (int depth = cursor.depth; depth >= 0; --depth)
+            path.push_back(board_.getPixelPosition(cursor.path[depth]));
+        pathes.push_back(path);
+    }
+
+    return pathes;
+}
+
+#endif // CURSOR_SEARCH_H_INCLUDED
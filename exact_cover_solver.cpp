@@ -0,0 +1,281 @@
+#include "exact_cover_solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+ExactCoverSolver::ExactCoverSolver (NodeMatrix const& board, HamiltonianOracle const* oracle)
+    : board_(board)
+    , oracle_(oracle)
+    , candidates_(board.getShapeCount())
+    , blocked_()
+    , restrictedValence_(board.getCellCount(), 0)
+    , chosen_(board.getShapeCount(), -1)
+    , chosenEdges_(0)
+    , deepestEdges_(0)
+    , budget_(nullptr)
+    , coverSteps_(0)
+{
+}
+
+bool ExactCoverSolver::enumerate(std::size_t maxCandidates, long long& stepCounter)
+{
+    auto shapes = board_.getShapeList();
+    for (int shapeIndex = 0; shapeIndex != static_cast <int> (shapes.size()); ++shapeIndex)
+    {
+        auto endpoints = board_.getStartEndPair(shapes[shapeIndex]);
+        if (!endpoints)
+            throw std::runtime_error("board is invalid");
+
+        auto start = board_.getIndex(endpoints.get().first);
+
+        // dead ends cost as much as paths, so the walk gets a budget as well.
+        Walk walk;
+        walk.shapeIndex = shapeIndex;
+        walk.target = board_.getIndex(endpoints.get().second);
+        walk.shapeCells = board_.getShapeCells(shapeIndex);
+        walk.visited = cellBit(start);
+        walk.cells.push_back(start);
+        walk.restrictedValence.assign(board_.getCellCount(), 0);
+        walk.maxCandidates = maxCandidates;
+        walk.budget = 64 * static_cast <long long> (maxCandidates) + 1024;
+        walk.aborted = false;
+
+        extend(walk, stepCounter);
+        if (walk.aborted)
+            return false;
+        if (candidates_[shapeIndex].empty())
+            throw std::runtime_error("No solution");
+    }
+    return true;
+}
+
+void ExactCoverSolver::extend(Walk& walk, long long& stepCounter)
+{
+    auto cell = walk.cells.back();
+    if (cell == walk.target)
+    {
+        if (walk.visited == walk.shapeCells)
+            addCandidate(walk);
+        return;
+    }
+
+    for (auto const& next : board_.getNeighbours(cell))
+    {
+        if (walk.aborted)
+            return;
+        if (walk.edges.test(next.edge))
+            continue;
+        auto crossing = board_.getCrossingEdge(next.edge);
+        if (crossing != -1 && walk.edges.test(crossing))
+            continue;
+
+        // the own nodes once and the target last, valence restricted nodes as long as they have valence left
+        auto bit = cellBit(next.cell);
+        bool restricted = board_.getShape(next.cell) == NodeShape::ValenceRestricted;
+        if (restricted)
+        {
+            if (walk.restrictedValence[next.cell] + 2 > board_.getRequiredValence(next.cell))
+                continue;
+        }
+        else if (!(walk.shapeCells & bit) || (walk.visited & bit))
+        {
+            continue;
+        }
+        else if (next.cell == walk.target && (walk.visited | bit) != walk.shapeCells)
+        {
+            continue;
+        }
+
+        if (oracle_ != nullptr && !oracle_->canComplete(walk.shapeIndex, restricted ? walk.visited : walk.visited | bit, next.cell))
+            continue;
+
+        if (--walk.budget < 0)
+        {
+            walk.aborted = true;
+            return;
+        }
+        if (budget_ != nullptr && budget_->countStep(coverSteps_))
+            budget_->interrupt();
+        stepCounter++;
+
+        auto visited = walk.visited;
+        if (!restricted)
+            walk.visited |= bit;
+        walk.edges.set(next.edge);
+        walk.cells.push_back(next.cell);
+        if (restricted)
+            walk.restrictedValence[next.cell] += 2;
+
+        extend(walk, stepCounter);
+
+        if (restricted)
+            walk.restrictedValence[next.cell] -= 2;
+        walk.cells.pop_back();
+        walk.edges.reset(next.edge);
+        walk.visited = visited;
+    }
+}
+
+void ExactCoverSolver::addCandidate(Walk& walk)
+{
+    auto& candidates = candidates_[walk.shapeIndex];
+    if (candidates.size() == walk.maxCandidates)
+    {
+        walk.aborted = true;
+        return;
+    }
+
+    Candidate candidate;
+    candidate.edges = walk.edges;
+    candidate.blocked = walk.edges;
+    for (int edge = 0; edge != board_.getEdgeCount(); ++edge)
+    {
+        auto crossing = board_.getCrossingEdge(edge);
+        if (walk.edges.test(edge) && crossing != -1)
+            candidate.blocked.set(crossing);
+    }
+    candidate.cells = walk.cells;
+    for (auto cells = board_.getValenceRestrictedCells(); cells; )
+    {
+        auto cell = popCell(cells);
+        if (walk.restrictedValence[cell] != 0)
+            candidate.restricted.emplace_back(cell, walk.restrictedValence[cell]);
+    }
+    candidates.push_back(std::move(candidate));
+}
+
+std::vector <NodePath> ExactCoverSolver::solve(long long& stepCounter, long long& backtrackCounter)
+{
+    std::vector <std::vector <int> > fitting(candidates_.size());
+    for (std::size_t i = 0; i != candidates_.size(); ++i)
+    {
+        for (int j = 0; j != static_cast <int> (candidates_[i].size()); ++j)
+            fitting[i].push_back(j);
+    }
+
+    if (!cover(fitting, stepCounter, backtrackCounter))
+        throw std::runtime_error("No solution");
+    return getPathes();
+}
+
+void ExactCoverSolver::setBudget(SolveBudget* budget)
+{
+    budget_ = budget;
+}
+
+std::vector <NodePath> ExactCoverSolver::getPathes() const
+{
+    // paths are reported from the target back to the start
+    std::vector <NodePath> pathes(candidates_.size());
+    for (std::size_t i = 0; i != candidates_.size(); ++i)
+    {
+        if (chosen_[i] == -1)
+            continue;
+
+        auto const& cells = candidates_[i][chosen_[i]].cells;
+        for (auto cell = cells.rbegin(); cell != cells.rend(); ++cell)
+            pathes[i].push_back(board_.getPixelPosition(*cell));
+    }
+    return pathes;
+}
+
+std::size_t ExactCoverSolver::getCandidateCount() const
+{
+    std::size_t count = 0;
+    for (auto const& i : candidates_)
+        count += i.size();
+    return count;
+}
+
+bool ExactCoverSolver::fits(Candidate const& candidate) const
+{
+    if ((candidate.edges & blocked_).any())
+        return false;
+    for (auto const& i : candidate.restricted)
+    {
+        if (restrictedValence_[i.first] + i.second > board_.getRequiredValence(i.first))
+            return false;
+    }
+    return true;
+}
+
+void ExactCoverSolver::choose(int shapeIndex, int candidate, int sign)
+{
+    auto const& chosen = candidates_[shapeIndex][candidate];
+    if (sign > 0)
+        blocked_ |= chosen.blocked;
+    else
+        blocked_ &= ~chosen.blocked; // the blocked sets of a cover never overlap in its edges
+    for (auto const& i : chosen.restricted)
+        restrictedValence_[i.first] += sign * i.second;
+    chosen_[shapeIndex] = sign > 0 ? candidate : -1;
+    if (sign > 0)
+        chosenEdges_ += chosen.cells.size() - 1;
+    else
+        chosenEdges_ -= chosen.cells.size() - 1;
+}
+
+bool ExactCoverSolver::cover(std::vector <std::vector <int> > const& fitting, long long& stepCounter, long long& backtrackCounter)
+{
+    // every valence restricted node has to be filled by the shapes still open
+    std::vector <int> missing(board_.getCellCount(), 0);
+    for (auto cells = board_.getValenceRestrictedCells(); cells; )
+    {
+        auto cell = popCell(cells);
+        missing[cell] = board_.getRequiredValence(cell) - restrictedValence_[cell];
+    }
+
+    // narrow the candidates of the open shapes down to those that still fit
+    std::vector <std::vector <int> > narrowed(fitting.size());
+    int best = -1;
+    for (std::size_t i = 0; i != fitting.size(); ++i)
+    {
+        if (chosen_[i] != -1)
+            continue;
+
+        std::vector <int> most(board_.getCellCount(), 0);
+        for (auto j : fitting[i])
+        {
+            auto const& candidate = candidates_[i][j];
+            if (!fits(candidate))
+                continue;
+            narrowed[i].push_back(j);
+            for (auto const& k : candidate.restricted)
+                most[k.first] = std::max(most[k.first], k.second);
+        }
+        if (narrowed[i].empty())
+            return false;
+        for (std::size_t cell = 0; cell != most.size(); ++cell)
+            missing[cell] -= most[cell];
+
+        if (best == -1 || narrowed[i].size() < narrowed[best].size())
+            best = static_cast <int> (i);
+    }
+
+    for (auto i : missing)
+    {
+        if (i > 0)
+            return false;
+    }
+    if (best == -1)
+        return true;
+
+    for (auto j : narrowed[best])
+    {
+        if (budget_ != nullptr && budget_->countStep(coverSteps_))
+            budget_->interrupt();
+
+        stepCounter++;
+        choose(best, j, 1);
+        if (budget_ != nullptr && chosenEdges_ > deepestEdges_)
+        {
+            deepestEdges_ = chosenEdges_;
+            budget_->offerPartial(getPathes(), chosenEdges_);
+        }
+        if (cover(narrowed, stepCounter, backtrackCounter))
+            return true;
+        choose(best, j, -1);
+        backtrackCounter++;
+    }
+    return false;
+}
@@ -0,0 +1,85 @@
+#ifndef EXACT_COVER_SOLVER_H_INCLUDED
+#define EXACT_COVER_SOLVER_H_INCLUDED
+
+#include "board_state.h"
+#include "hamiltonian_oracle.h"
+#include "node_matrix.h"
+#include "path.h"
+#include "solve_budget.h"
+
+#include <vector>
+
+/**
+ *  Solves a board in two phases instead of walking all shapes at once.
+ *  First every legal path of each shape is enumerated on its own, then one path per shape
+ *  is picked such that no edge is used twice, no two diagonals cross and every valence
+ *  restricted node gets exactly its valence (Algorithm X, the shape with the fewest
+ *  fitting candidates first).
+ *
+ *  Fast when the shapes have few paths, enumerate() gives up on boards where they don't.
+ */
+class ExactCoverSolver
+{
+public:
+    ExactCoverSolver (NodeMatrix const& board, HamiltonianOracle const* oracle = nullptr);
+
+    // false if a shape has more than maxCandidates paths or takes too long to enumerate
+    bool enumerate(std::size_t maxCandidates, long long& stepCounter);
+
+    // paths in the order of NodeMatrix::getShapeList(), from the target back to the start
+    std::vector <NodePath> solve(long long& stepCounter, long long& backtrackCounter);
+
+    // checked by solve() before it chooses a path, the deepest cover so far is the partial state
+    void setBudget(SolveBudget* budget);
+
+    std::size_t getCandidateCount() const;
+
+private:
+    struct Candidate
+    {
+        EdgeSet edges;
+        EdgeSet blocked; // the edges and the diagonals crossing them
+        std::vector <CellIndex> cells; // start to target
+        std::vector <std::pair <CellIndex, int> > restricted; // valence taken from each valence restricted node
+    };
+
+    struct Walk
+    {
+        int shapeIndex;
+        CellIndex target;
+        CellMask shapeCells;
+        CellMask visited;
+        EdgeSet edges;
+        std::vector <CellIndex> cells;
+        std::vector <int> restrictedValence;
+        std::size_t maxCandidates;
+        long long budget;
+        bool aborted;
+    };
+
+    void extend(Walk& walk, long long& stepCounter);
+    void addCandidate(Walk& walk);
+    bool cover(std::vector <std::vector <int> > const& fitting, long long& stepCounter, long long& backtrackCounter);
+    bool fits(Candidate const& candidate) const;
+    void choose(int shapeIndex, int candidate, int sign);
+
+    // the chosen paths, empty for the shapes without one
+    std::vector <NodePath> getPathes() const;
+
+private:
+    NodeMatrix const& board_;
+    HamiltonianOracle const* oracle_;
+    std::vector <std::vector <Candidate> > candidates_; // per shape
+
+    // the cover so far
+    EdgeSet blocked_;
+    std::vector <int> restrictedValence_; // per cell
+    std::vector <int> chosen_; // per shape, -1 if none yet
+    std::size_t chosenEdges_;
+    std::size_t deepestEdges_;
+
+    SolveBudget* budget_;
+    long long coverSteps_; // not charged to the budget yet
+};
+
+#endif // EXACT_COVER_SOLVER_H_INCLUDED
@@ -0,0 +1,140 @@
+#include "hamiltonian_oracle.h"
+
+#include <algorithm>
+
+constexpr int HamiltonianOracle::maxTableCells;
+
+namespace
+{
+    // sets of nodes filled between two questions to stop
+    constexpr std::uint32_t stopInterval = 4096;
+}
+
+HamiltonianOracle::HamiltonianOracle (NodeMatrix const& board, int maxCells, std::function <bool ()> const& stop)
+    : shapes_(board.getShapeCount())
+    , complete_(true)
+{
+    maxCells = std::min(maxCells, maxTableCells);
+    for (int shapeIndex = 0; shapeIndex != board.getShapeCount() && complete_; ++shapeIndex)
+    {
+        auto cells = board.getShapeCells(shapeIndex);
+        if (__builtin_popcountll(cells) > maxCells)
+            continue;
+
+        auto& shape = shapes_[shapeIndex];
+        shape.local.assign(board.getCellCount(), -1);
+        while (cells)
+        {
+            auto cell = popCell(cells);
+            shape.local[cell] = static_cast <std::int8_t> (shape.cells.size());
+            shape.cells.push_back(cell);
+        }
+
+        complete_ = buildTable(board, shapeIndex, shape, stop);
+    }
+}
+
+bool HamiltonianOracle::buildTable(NodeMatrix const& board, int shapeIndex, ShapeTable& shape, std::function <bool ()> const& stop) const
+{
+    auto shapeCells = board.getShapeCells(shapeIndex);
+    auto restricted = board.getValenceRestrictedCells();
+
+    auto toLocal = [&](CellMask cells)
+    {
+        std::uint32_t mask = 0;
+        while (cells)
+            mask |= std::uint32_t{1} << shape.local[popCell(cells)];
+        return mask;
+    };
+
+    // nodes of the shape reachable from a cell through valence restricted nodes only
+    shape.restrictedLinks.assign(board.getCellCount(), 0);
+    for (auto cells = restricted; cells; )
+    {
+        auto cell = popCell(cells);
+        auto area = cellBit(cell);
+        for (;;)
+        {
+            auto next = area | (board.growCells(area) & restricted);
+            if (next == area)
+                break;
+            area = next;
+        }
+        shape.restrictedLinks[cell] = toLocal(board.growCells(area) & shapeCells);
+    }
+
+    auto count = static_cast <int> (shape.cells.size());
+    shape.links.assign(count, 0);
+    for (int i = 0; i != count; ++i)
+    {
+        auto cell = shape.cells[i];
+        auto links = toLocal(board.getNeighbourCells(cell) & shapeCells);
+        for (auto neighbours = board.getNeighbourCells(cell) & restricted; neighbours; )
+            links |= shape.restrictedLinks[popCell(neighbours)];
+        shape.links[i] = links & ~(std::uint32_t{1} << i);
+    }
+
+    auto endpoints = board.getStartEndPair(board.getShapeList()[shapeIndex]);
+    if (!endpoints)
+        return true;
+
+    auto target = shape.local[board.getIndex(endpoints.get().second)];
+    auto targetBit = std::uint32_t{1} << target;
+
+    // sets without the target stay empty, smaller sets come first.
+    shape.table.assign(std::size_t{1} << count, 0);
+    shape.table[targetBit] = targetBit;
+    for (std::uint32_t set = 0; set != shape.table.size(); ++set)
+    {
+        if (stop && set % stopInterval == 0 && stop())
+        {
+            std::vector <std::uint32_t> ().swap(shape.table);
+            return false;
+        }
+        if (!(set & targetBit) || set == targetBit)
+            continue;
+
+        std::uint32_t starts = 0;
+        for (auto nodes = set & ~targetBit; nodes; nodes &= nodes - 1)
+        {
+            auto node = __builtin_ctz(nodes);
+            auto bit = std::uint32_t{1} << node;
+            if (shape.links[node] & shape.table[set & ~bit])
+                starts |= bit;
+        }
+        shape.table[set] = starts;
+    }
+    return true;
+}
+
+bool HamiltonianOracle::hasTable(int shapeIndex) const
+{
+    return !shapes_[shapeIndex].table.empty();
+}
+
+bool HamiltonianOracle::isComplete() const
+{
+    return complete_;
+}
+
+bool HamiltonianOracle::canComplete(int shapeIndex, CellMask visited, CellIndex position) const
+{
+    auto const& shape = shapes_[shapeIndex];
+    if (shape.table.empty())
+        return true;
+
+    std::uint32_t remaining = 0;
+    for (int i = 0; i != static_cast <int> (shape.cells.size()); ++i)
+        if (!(visited & cellBit(shape.cells[i])))
+            remaining |= std::uint32_t{1} << i;
+
+    auto local = shape.local[position];
+    if (local != -1)
+    {
+        remaining |= std::uint32_t{1} << local;
+        return (shape.table[remaining] >> local) & 1;
+    }
+
+    // on a valence restricted node, the path goes on with any node it leads to.
+    return (shape.restrictedLinks[position] & shape.table[remaining]) != 0;
+}
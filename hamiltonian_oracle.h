@@ -0,0 +1,58 @@
+#ifndef HAMILTONIAN_ORACLE_H_INCLUDED
+#define HAMILTONIAN_ORACLE_H_INCLUDED
+
+#include "node_matrix.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ *  Tells whether the path of a shape can still be completed, from a precomputed table.
+ *
+ *  The path has to visit every node of its shape exactly once and end at the target.
+ *  Between two nodes of the shape it may only take valence restricted nodes, so two nodes
+ *  are linked if they are neighbours or a chain of valence restricted nodes joins them.
+ *  For every set of nodes still to visit and every node in it, the table holds whether a
+ *  path through the links covers the set and ends at the target. The links ignore all
+ *  connections, so a negative answer is final.
+ *
+ *  Built once per board and never modified, one instance can serve several searches.
+ */
+class HamiltonianOracle
+{
+public:
+    // a table takes 4 << n bytes for a shape of n nodes, 64 MiB and some 300 ms to build at this limit
+    static constexpr int maxTableCells = 24;
+
+    // shapes with more than maxCells nodes get no table, maxCells is clamped to maxTableCells.
+    // stop is asked while the tables are filled, once it says so the remaining shapes get none.
+    explicit HamiltonianOracle (NodeMatrix const& board, int maxCells = 16, std::function <bool ()> const& stop = {});
+
+    bool hasTable(int shapeIndex) const;
+
+    // false if stop cut the build short
+    bool isComplete() const;
+
+    // can the path of the shape, which went through visited and stands on position, still be completed?
+    bool canComplete(int shapeIndex, CellMask visited, CellIndex position) const;
+
+private:
+    struct ShapeTable
+    {
+        std::vector <CellIndex> cells; // the nodes of the shape
+        std::vector <std::int8_t> local; // position of a cell in cells, -1 for other cells
+        std::vector <std::uint32_t> links; // per node, the nodes it is linked with
+        std::vector <std::uint32_t> restrictedLinks; // per valence restricted cell, the nodes it leads to
+        std::vector <std::uint32_t> table; // per set of nodes to visit, the nodes a covering path can start at
+    };
+
+    // false if stop said so, the table is left empty then
+    bool buildTable(NodeMatrix const& board, int shapeIndex, ShapeTable& shape, std::function <bool ()> const& stop) const;
+
+private:
+    std::vector <ShapeTable> shapes_;
+    bool complete_;
+};
+
+#endif // HAMILTONIAN_ORACLE_H_INCLUDED
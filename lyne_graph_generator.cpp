@@ -202,24 +202,21 @@ void LYNEGenerator::classifyShapesIntoNodes(std::vector <Shape> const& shapes, s
     }
 }
 
-std::vector <std::vector <Node> > LYNEGenerator::createMatrix(std::vector <Node> nodes, std::vector <int> const& xGrid, std::vector <int> const& yGrid)
+NodeMatrix LYNEGenerator::createMatrix(std::vector <Node> nodes, std::vector <int> const& xGrid, std::vector <int> const& yGrid)
 {
-    std::vector <std::vector <Node> > result;
-    result.resize(xGrid.size());
-    for (auto& i : result)
-    {
-        i.resize(yGrid.size());
-    }
+    auto width = static_cast <int> (xGrid.size());
+    auto height = static_cast <int> (yGrid.size());
 
+    std::vector <Node> cells(width * height);
     for (auto const& i : nodes)
     {
         auto xGridPos = std::distance(std::begin(xGrid), std::find(std::begin(xGrid), std::end(xGrid), i.position.x));
         auto yGridPos = std::distance(std::begin(yGrid), std::find(std::begin(yGrid), std::end(yGrid), i.position.y));
 
-        result[xGridPos][yGridPos] = i;
+        cells[yGridPos * width + xGridPos] = i;
     }
 
-    return result;
+    return {width, height, cells};
 }
 
 NodeMatrix LYNEGenerator::generate()
@@ -236,7 +233,7 @@ NodeMatrix LYNEGenerator::generate()
     classifyShapesIntoNodes(shapes, nodes);
     createGrid(nodes, xGrid, yGrid);
 
-    return {createMatrix(nodes, xGrid, yGrid)};
+    return createMatrix(nodes, xGrid, yGrid);
 
     // 0xDFF1E9 = center
 }
@@ -22,7 +22,7 @@ public:
 private:
     void createGrid(std::vector <Node>& nodes, std::vector <int>& xGrid, std::vector <int>& yGrid);
     void classifyShapesIntoNodes(std::vector <Shape> const& shapes, std::vector <Node>& nodes);
-    std::vector <std::vector <Node> > createMatrix(std::vector <Node> nodes, std::vector <int> const& xGrid, std::vector <int> const& yGrid);
+    NodeMatrix createMatrix(std::vector <Node> nodes, std::vector <int> const& xGrid, std::vector <int> const& yGrid);
 
 private:
     cv::Mat original_;
@@ -0,0 +1,307 @@
+#include "lyne_sat_encoder.h"
+
+#include <stdexcept>
+
+LYNESatEncoder::LYNESatEncoder (NodeMatrix const& board)
+    : board_(board)
+    , shapeCount_(board.getShapeCount())
+    , starts_()
+    , targets_()
+    , edges_()
+    , edgeVariables_(board.getEdgeCount() * board.getShapeCount(), -1)
+    , usedVariables_(board.getEdgeCount(), -1)
+    , solver_()
+    , budget_(nullptr)
+{
+    for (auto const& i : board.getShapeList())
+    {
+        auto endpoints = board.getStartEndPair(i);
+        if (!endpoints)
+            throw std::runtime_error("board is invalid");
+        starts_.push_back(board.getIndex(endpoints.get().first));
+        targets_.push_back(board.getIndex(endpoints.get().second));
+    }
+
+    encode();
+}
+
+void LYNESatEncoder::encode()
+{
+    // a shape can use an edge if both of its cells are its own nodes or valence restricted
+    for (auto cells = board_.getNodeCells(); cells; )
+    {
+        auto cell = popCell(cells);
+        for (auto const& next : board_.getNeighbours(cell))
+        {
+            if (next.cell < cell)
+                continue;
+
+            std::vector <Literal> shapes;
+            for (int shapeIndex = 0; shapeIndex != shapeCount_; ++shapeIndex)
+            {
+                auto allowed = board_.getShapeCells(shapeIndex) | board_.getValenceRestrictedCells();
+                if ((allowed & cellBit(cell)) && (allowed & cellBit(next.cell)))
+                {
+                    auto variable = solver_.addVariable();
+                    edgeVariables_[next.edge * shapeCount_ + shapeIndex] = variable;
+                    shapes.push_back(makeLiteral(variable));
+                }
+            }
+            if (shapes.empty())
+                continue;
+
+            // used <=> exactly one of the shapes
+            edges_.push_back(next.edge);
+            auto used = solver_.addVariable();
+            usedVariables_[next.edge] = used;
+            auto clause = shapes;
+            clause.push_back(makeLiteral(used, true));
+            solver_.addClause(clause);
+            for (std::size_t i = 0; i != shapes.size(); ++i)
+            {
+                solver_.addClause({negateLiteral(shapes[i]), makeLiteral(used)});
+                for (std::size_t j = i + 1; j != shapes.size(); ++j)
+                    solver_.addClause({negateLiteral(shapes[i]), negateLiteral(shapes[j])});
+            }
+        }
+    }
+
+    // crossing diagonals
+    for (auto edge : edges_)
+    {
+        auto crossing = board_.getCrossingEdge(edge);
+        if (crossing != -1 && crossing > edge && usedVariables_[crossing] != -1)
+            solver_.addClause({makeLiteral(usedVariables_[edge], true), makeLiteral(usedVariables_[crossing], true)});
+    }
+
+    // valences. A shape passes a valence restricted node, it never ends there.
+    for (auto cells = board_.getNodeCells(); cells; )
+    {
+        auto cell = popCell(cells);
+        auto shapeIndex = board_.getShapeIndex(cell);
+
+        std::vector <Literal> used;
+        std::vector <std::vector <Literal> > byShape(shapeCount_);
+        for (auto const& next : board_.getNeighbours(cell))
+        {
+            if (usedVariables_[next.edge] == -1)
+                continue;
+            used.push_back(makeLiteral(usedVariables_[next.edge]));
+            for (int i = 0; i != shapeCount_; ++i)
+            {
+                if (getEdgeVariable(next.edge, i) != -1)
+                    byShape[i].push_back(makeLiteral(getEdgeVariable(next.edge, i)));
+            }
+        }
+
+        addExactly(used, board_.getRequiredValence(cell));
+        if (shapeIndex == -1)
+        {
+            for (auto const& i : byShape)
+                addEven(i);
+        }
+    }
+}
+
+void LYNESatEncoder::addExactly(std::vector <Literal> const& literals, int count)
+{
+    auto size = static_cast <int> (literals.size());
+    if (count > size)
+    {
+        solver_.addClause({});
+        return;
+    }
+
+    // a node has at most eight edges, so every subset can get its own clause:
+    // no count + 1 of them are used, no size - count + 1 of them are unused.
+    for (unsigned subset = 0; subset != 1u << size; ++subset)
+    {
+        auto chosen = __builtin_popcount(subset);
+        for (int used = 0; used != 2; ++used)
+        {
+            if (chosen != (used ? count + 1 : size - count + 1))
+                continue;
+
+            std::vector <Literal> clause;
+            for (int i = 0; i != size; ++i)
+            {
+                if (subset & (1u << i))
+                    clause.push_back(used ? negateLiteral(literals[i]) : literals[i]);
+            }
+            solver_.addClause(clause);
+        }
+    }
+}
+
+void LYNESatEncoder::addEven(std::vector <Literal> const& literals)
+{
+    // forbid every odd assignment
+    auto size = static_cast <int> (literals.size());
+    for (unsigned subset = 0; subset != 1u << size; ++subset)
+    {
+        if (__builtin_popcount(subset) % 2 == 0)
+            continue;
+
+        std::vector <Literal> clause;
+        for (int i = 0; i != size; ++i)
+            clause.push_back(subset & (1u << i) ? negateLiteral(literals[i]) : literals[i]);
+        solver_.addClause(clause);
+    }
+}
+
+bool LYNESatEncoder::isUsed(EdgeIndex edge, int shapeIndex) const
+{
+    auto variable = getEdgeVariable(edge, shapeIndex);
+    return variable != -1 && solver_.getValue(variable);
+}
+
+void LYNESatEncoder::findCuts(int shapeIndex, std::vector <std::vector <Literal> >& cuts) const
+{
+    // cells and edges of the shape in the model
+    CellMask cells = 0;
+    std::vector <EdgeIndex> used;
+    for (auto edge : edges_)
+    {
+        if (!isUsed(edge, shapeIndex))
+            continue;
+        used.push_back(edge);
+        cells |= cellBit(board_.getEdgeCells(edge).first) | cellBit(board_.getEdgeCells(edge).second);
+    }
+
+    auto connected = [&](CellIndex from)
+    {
+        auto part = cellBit(from);
+        for (bool grown = true; grown; )
+        {
+            grown = false;
+            for (auto edge : used)
+            {
+                auto ends = board_.getEdgeCells(edge);
+                auto both = cellBit(ends.first) | cellBit(ends.second);
+                if ((part & both) && (part & both) != both)
+                {
+                    part |= both;
+                    grown = true;
+                }
+            }
+        }
+        return part;
+    };
+
+    // the path is the part with the start, everything else are cycles.
+    auto rest = cells & ~connected(starts_[shapeIndex]);
+    while (rest)
+    {
+        auto cycle = connected(popCell(rest));
+        rest &= ~cycle;
+
+        // the path has to leave the cycle's cells to reach them. Without nodes of the shape
+        // the cycle is only wrong while one of its edges is used.
+        std::vector <Literal> cut;
+        if (!(cycle & board_.getShapeCells(shapeIndex)))
+        {
+            for (auto edge : used)
+            {
+                if (cycle & cellBit(board_.getEdgeCells(edge).first))
+                {
+                    cut.push_back(makeLiteral(getEdgeVariable(edge, shapeIndex), true));
+                    break;
+                }
+            }
+        }
+        for (auto edge : edges_)
+        {
+            auto ends = board_.getEdgeCells(edge);
+            auto inside = ((cycle >> ends.first) & 1) + ((cycle >> ends.second) & 1);
+            if (inside == 1 && getEdgeVariable(edge, shapeIndex) != -1)
+                cut.push_back(makeLiteral(getEdgeVariable(edge, shapeIndex)));
+        }
+        cuts.push_back(cut);
+    }
+}
+
+NodePath LYNESatEncoder::decodePath(int shapeIndex) const
+{
+    // Hierholzer: a valence restricted node may be passed more than once, the walk
+    // has to use every edge before it settles at the target.
+    std::vector <char> walked(board_.getEdgeCount(), 0);
+    std::vector <CellIndex> stack{starts_[shapeIndex]};
+    NodePath path;
+    while (!stack.empty())
+    {
+        auto cell = stack.back();
+        bool moved = false;
+        for (auto const& next : board_.getNeighbours(cell))
+        {
+            if (!walked[next.edge] && isUsed(next.edge, shapeIndex))
+            {
+                walked[next.edge] = 1;
+                stack.push_back(next.cell);
+                moved = true;
+                break;
+            }
+        }
+        if (!moved)
+        {
+            // cells leave the stack from the target back to the start
+            path.push_back(board_.getPixelPosition(cell));
+            stack.pop_back();
+        }
+    }
+    return path;
+}
+
+void LYNESatEncoder::setBudget(SolveBudget* budget)
+{
+    budget_ = budget;
+    if (budget == nullptr)
+    {
+        solver_.setStopCondition({});
+        return;
+    }
+
+    // one of the two grows with every round of the solver
+    auto charged = solver_.getDecisions() + solver_.getConflicts();
+    solver_.setStopCondition([this, charged]() mutable
+    {
+        auto steps = solver_.getDecisions() + solver_.getConflicts();
+        if (steps - charged >= SolveBudget::chargeInterval)
+        {
+            budget_->charge(steps - charged);
+            charged = steps;
+        }
+        return budget_->isExhausted(steps - charged);
+    });
+}
+
+std::vector <NodePath> LYNESatEncoder::solve(long long& stepCounter, long long& backtrackCounter)
+{
+    auto decisions = solver_.getDecisions();
+    auto conflicts = solver_.getConflicts();
+    for (;;)
+    {
+        bool solved = solver_.solve();
+        stepCounter += solver_.getDecisions() - decisions;
+        backtrackCounter += solver_.getConflicts() - conflicts;
+        decisions = solver_.getDecisions();
+        conflicts = solver_.getConflicts();
+        if (!solved && solver_.isInterrupted())
+            budget_->interrupt();
+        if (!solved)
+            throw std::runtime_error("No solution");
+
+        // adding clauses resets the model, so all cuts are found first
+        std::vector <std::vector <Literal> > cuts;
+        for (int shapeIndex = 0; shapeIndex != shapeCount_; ++shapeIndex)
+            findCuts(shapeIndex, cuts);
+        if (cuts.empty())
+            break;
+        for (auto const& i : cuts)
+            solver_.addClause(i);
+    }
+
+    std::vector <NodePath> pathes;
+    for (int shapeIndex = 0; shapeIndex != shapeCount_; ++shapeIndex)
+        pathes.push_back(decodePath(shapeIndex));
+    return pathes;
+}
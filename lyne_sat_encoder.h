@@ -0,0 +1,59 @@
+#ifndef LYNE_SAT_ENCODER_H_INCLUDED
+#define LYNE_SAT_ENCODER_H_INCLUDED
+
+#include "node_matrix.h"
+#include "path.h"
+#include "sat_solver.h"
+#include "solve_budget.h"
+
+#include <vector>
+
+/**
+ *  Solves a board with the SatSolver. Every edge gets a variable per shape that may use it,
+ *  the valences become cardinality constraints and crossing diagonals exclude each other.
+ *  A shape may pass a valence restricted node several times, so it uses an even number of
+ *  its edges there.
+ *
+ *  The constraints still allow a shape to form cycles next to its path. Connectivity is
+ *  added lazily: every cycle found in a model gets a cut, then the solver runs again.
+ */
+class LYNESatEncoder
+{
+public:
+    explicit LYNESatEncoder (NodeMatrix const& board);
+
+    // paths in the order of NodeMatrix::getShapeList(), from the target back to the start
+    std::vector <NodePath> solve(long long& stepCounter, long long& backtrackCounter);
+
+    // counts decisions and conflicts as steps. A model is no path, so there is no partial state.
+    void setBudget(SolveBudget* budget);
+
+private:
+    void encode();
+    void addExactly(std::vector <Literal> const& literals, int count);
+    void addEven(std::vector <Literal> const& literals);
+
+    // a cut for every part of the shape in the model that is not connected to its start
+    void findCuts(int shapeIndex, std::vector <std::vector <Literal> >& cuts) const;
+    NodePath decodePath(int shapeIndex) const;
+
+    inline int getEdgeVariable(EdgeIndex edge, int shapeIndex) const
+    {
+        return edgeVariables_[edge * shapeCount_ + shapeIndex];
+    }
+
+    bool isUsed(EdgeIndex edge, int shapeIndex) const;
+
+private:
+    NodeMatrix const& board_;
+    int shapeCount_;
+    std::vector <CellIndex> starts_; // per shape
+    std::vector <CellIndex> targets_;
+    std::vector <EdgeIndex> edges_; // edges some shape could use
+    std::vector <int> edgeVariables_; // per edge and shape, -1 if the shape can't use the edge
+    std::vector <int> usedVariables_; // per edge, true if any shape uses it
+    SatSolver solver_;
+    SolveBudget* budget_;
+};
+
+#endif // LYNE_SAT_ENCODER_H_INCLUDED
@@ -1,323 +1,324 @@
 #include "lyne_solver.h"
-#include "matrix_cursor.h"
+#include "best_first_solver.h"
+#include "board_decomposition.h"
+#include "cursor_search.h"
+#include "exact_cover_solver.h"
+#include "lyne_sat_encoder.h"
+#include "parallel_search.h"
+#include "portfolio_search.h"
+#include "solution_enumeration.h"
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
-#include <iostream>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
 
 LYNESolver::LYNESolver (NodeMatrix matrix, cv::Mat const& solutionDisplay)
     : LYNEMatrix_(matrix)
     , orig_()
     , solutionDisplay_()
+    , statistics_()
+    , oracle_()
+    , oracleMaxCells_(0)
+    , groupOracles_()
+    , groupOracleMaxCells_(0)
 {
     solutionDisplay.copyTo(orig_);
 }
 
-bool LYNESolver::canConnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2, NodeShape type)
+void LYNESolver::drawSolution(std::vector <NodePath> const& paths)
 {
-    // OOR checks
-    if (n1.x >= matrix.getWidth() || n2.x >= matrix.getWidth())
-        return false;
-    if (n1.y >= matrix.getHeight() || n2.y >= matrix.getHeight())
-        return false;
+    solutionDisplay_ = orig_.clone();
 
-    // Check for correct color
-    Node& node1 = matrix.get(n1);
-    Node& node2 = matrix.get(n2);
-
-    // Check for max valence
-    if (node1.requiredValence == node1.valence || node2.requiredValence == node2.valence)
-        return false;
-
-    // Manhattan Distance checks (algo does not do this)
-    // if (!(std::abs(n1.x - n2.x) <= 1 && std::abs(n1.y - n2.y) <= 1))
-    //    return false;
-
-    auto isConnected = [&](MatrixPosition a, MatrixPosition b)
+    auto shapes = LYNEMatrix_.getShapeList();
+    for (std::size_t i = 0; i != paths.size(); ++i)
     {
-        if (!matrix.isNode(a))
-            return false;
-
-        if (!matrix.isNode(b))
-            return false;
-
-        Node& node1 = matrix.get(a);
-        Node& node2 = matrix.get(b);
-
-        for (auto const& i : node1.connections)
-            if (i.first == &node2)
-                return true;
-
-        return false;
-    };
-
-    // Existing connection check
-    if (isConnected(n1, n2))
-        return false;
-
-    // Check for diagonal block
-    if (std::abs(n1.x - n2.x) == 1 && std::abs(n1.y - n2.y) == 1) // is diagonal move
-    {
-        if (isConnected ({n2.x, n1.y}, {n1.x, n2.y}))
-            return false;
-    }
-
-    if ((node1.shape != type && node1.shape != NodeShape::ValenceRestricted) ||
-        (node2.shape != type && node2.shape != NodeShape::ValenceRestricted))
-    {
-        return false;
+        for (std::size_t j = 1; j < paths[i].size(); ++j)
+            line(solutionDisplay_, paths[i][j], paths[i][j - 1], cv::Scalar(ShapeToVector(shapes[i])), 10);
     }
-
-    return true;
 }
 
-void LYNESolver::forceConnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2, NodeShape type)
+namespace
 {
-    Node& node1 = matrix.get(n1);
-    Node& node2 = matrix.get(n2);
-
-    node1.connections.push_back(std::make_pair (&node2, type));
-    node2.connections.push_back(std::make_pair (&node1, type));
-
-    node1.valence++;
-    node2.valence++;
-}
-
-bool LYNESolver::tryConnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2, NodeShape type)
-{
-    if (canConnect(matrix, n1, n2, type))
+    struct SolveWithGeometry
     {
-        forceConnect(matrix, n1, n2, type);
-        return true;
-    }
-    return false;
-}
-
-void LYNESolver::forceDisconnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2)
-{
-    Node& node1 = matrix.get(n1);
-    Node& node2 = matrix.get(n2);
-
-    auto disconnect = [&](Node& node, Node* otherNode) {
-        for (auto iter = std::begin(node.connections); iter != std::end(node.connections); ++iter)
+        using result_type = std::vector <NodePath>;
+
+        NodeMatrix const& matrix;
+        SolveOptions const& options;
+        long long& stepCounter;
+        long long& backtrackCounter;
+        SolveStatistics& statistics;
+        HamiltonianOracle const* oracle;
+        SolveBudget* budget;
+
+        template <typename Geometry>
+        result_type operator()(Geometry geometry)
         {
-            if (iter->first == otherNode)
-            {
-                node.connections.erase(iter);
-                break;
-            }
+            if (options.portfolio > 1)
+                return runPortfolioSearch(matrix, geometry, options, oracle, budget, stepCounter, backtrackCounter, statistics);
+            if (options.threads != 1)
+                return runParallelSearch(matrix, geometry, options, oracle, budget, stepCounter, backtrackCounter, statistics);
+
+            CursorSearch <Geometry> search(matrix, geometry, options, stepCounter, backtrackCounter, statistics, oracle);
+            search.setBudget(budget);
+            auto pathes = search.run();
+            if (search.isCancelled())
+                budget->interrupt();
+            return pathes;
         }
-        node.valence--;
     };
 
-    disconnect(node1, &node2);
-    disconnect(node2, &node1);
-}
-
-bool LYNESolver::isSolution(NodeMatrix const& mat)
-{
-    bool isSol = true;
-    for (auto const& i : (mat.getNodes()))
+    struct EnumerateWithGeometry
     {
-        for (auto const& j : i)
+        using result_type = std::size_t;
+
+        NodeMatrix const& matrix;
+        SolveOptions const& options;
+        long long& stepCounter;
+        long long& backtrackCounter;
+        SolveStatistics& statistics;
+        HamiltonianOracle const* oracle;
+        SolveBudget* budget;
+        LYNESolver::SolutionCallback const& onSolution;
+        std::size_t limit;
+
+        template <typename Geometry>
+        result_type operator()(Geometry geometry)
         {
-            if (j.valence != j.requiredValence)
-            {
-                isSol = false;
-                goto STEP_OUT;
-            }
+            return runEnumeration(matrix, geometry, options, oracle, budget, stepCounter, backtrackCounter, statistics, onSolution, limit);
         }
-    }
+    };
 
-    STEP_OUT:
+    // Boards of common sizes get a search specialised for their dimensions.
+    // Throws SolveInterrupted once the budget runs out.
+    std::vector <NodePath> solveBoard(NodeMatrix const& matrix, SolveOptions const& options, HamiltonianOracle const* oracle, SolveBudget* budget,
+                                      long long& stepCounter, long long& backtrackCounter, SolveStatistics& statistics)
     {
-        return isSol;
-    }
-}
-
-bool LYNESolver::couldBeShapeSolution(NodeMatrix const& mat, NodeShape shape)
-{
-    bool isSol = true;
-    for (auto const& i : (mat.getNodes()))
-    {
-        for (auto const& j : i)
+        if (options.engine == SolveEngine::ExactCover)
         {
-            if (j.shape != shape)
-                continue;
-
-            if (j.valence != j.requiredValence)
-            {
-                isSol = false;
-                goto STEP_OUT;
-            }
+            ExactCoverSolver cover(matrix, oracle);
+            cover.setBudget(budget);
+            if (cover.enumerate(options.maxCandidatePaths, stepCounter))
+                return cover.solve(stepCounter, backtrackCounter);
+        }
+        else if (options.engine == SolveEngine::Sat)
+        {
+            LYNESatEncoder encoder(matrix);
+            encoder.setBudget(budget);
+            return encoder.solve(stepCounter, backtrackCounter);
+        }
+        else if (options.engine == SolveEngine::BestFirst)
+        {
+            BestFirstSolver bestFirst(matrix, options, oracle);
+            bestFirst.setBudget(budget);
+            return bestFirst.solve(stepCounter, backtrackCounter);
         }
-    }
-
-    STEP_OUT:
-    {
-        return isSol;
-    }
-}
-
-std::vector <NodePath> LYNESolver::solve(long long& stepCounter, long long& backtrackCounter)
-{
-    // make a copy of the game board used for modification:
-    auto matrix = LYNEMatrix_;
-
-    // get all shape types in the board:
-    auto shapes = matrix.getShapeList();
-
-    // make the cursors for each shape
-    std::vector <MatrixCursor> cursors;
 
-    for (auto const& i : shapes)
-    {
-        boost::optional <std::pair <MatrixPosition, MatrixPosition> > endpoints = matrix.getStartEndPair(i);
-        if (!endpoints)
-            throw std::runtime_error("board is invalid");
-
-        cursors.push_back ({
-            endpoints.get().first,
-            endpoints.get().second,
-            i
-        });
+        SolveWithGeometry solveWith{matrix, options, stepCounter, backtrackCounter, statistics, oracle, budget};
+        return withGeometry(matrix, solveWith);
     }
 
-    // now start backtracking algorithm
-    auto makeStep = [&](MatrixCursor const& cursor, MatrixCursor& nextCursor) -> bool
+    // every group on its board and in a thread of its own. A group without solution stops the
+    // others. An interrupted solve reports the solved groups and the partial states of the others.
+    std::vector <NodePath> solveGroups(NodeMatrix const& matrix, std::vector <std::vector <int> > const& groups, std::vector <NodeMatrix> const& boards,
+                                       std::vector <HamiltonianOracle const*> const& oracles, SolveOptions const& options,
+                                       SolveBudget* budget, long long& stepCounter, long long& backtrackCounter, SolveStatistics& statistics)
     {
-        auto adjacentPositions = matrix.getAdjacent(cursor.position, cursor.stepBlackList);
+        struct GroupResult
+        {
+            std::vector <NodePath> pathes; // partial if interrupted
+            bool interrupted = false;
+            long long stepCounter = 0;
+            long long backtrackCounter = 0;
+            SolveStatistics statistics;
+        };
 
-        //std::random_shuffle(std::begin(adjacentPositions), std::end(adjacentPositions));
+        // a thread per group already, the searches of the groups divide the rest
+        auto groupOptions = options;
+        groupOptions.threads = std::max(1u, getThreadCount(options) / static_cast <unsigned> (groups.size()));
 
-        MatrixPosition next;
-        auto findPossibleStep = [&]() -> bool
+        std::vector <GroupResult> results(groups.size());
+        std::atomic <bool> failed(false);
+        std::vector <std::future <void> > tasks;
+        for (std::size_t i = 0; i != groups.size(); ++i)
         {
-            for (auto const& i : adjacentPositions)
+            tasks.push_back(std::async(std::launch::async, [&boards, &oracles, &groupOptions, budget, &results, &failed, i]()
             {
-                // blacklisted are already filtered
-                if (tryConnect(matrix, cursor.position, i, cursor.shape))
+                auto& result = results[i];
+                SolveBudget groupBudget(budget, &failed);
+                try
                 {
-                    next = i;
-                    return true;
+                    result.pathes = solveBoard(boards[i], groupOptions, oracles[i], &groupBudget, result.stepCounter, result.backtrackCounter, result.statistics);
                 }
-            }
-            return false;
-        };
-
-        if (findPossibleStep())
-        {
-            stepCounter++;
-            nextCursor = decendCursor(cursor, next);
-            return true;
+                catch (SolveInterrupted const& interruption)
+                {
+                    result.pathes = interruption.getPartial();
+                    result.interrupted = true;
+                }
+                catch (...)
+                {
+                    failed = true;
+                    throw;
+                }
+            }));
         }
-        else
-            return false;
-    };
-
-    auto drawSolution = [&]() {
-        solutionDisplay_ = orig_.clone();
 
-        for (auto const& i : cursors)
+        // all tasks have to finish before the results go out of scope
+        std::exception_ptr failure;
+        for (auto& i : tasks)
         {
-            MatrixCursor const* c = &i;
-            while (c->previous)
+            try
             {
-                line(solutionDisplay_, matrix.get(c->position).position, matrix.get(c->previous.get()->position).position, cv::Scalar(ShapeToVector(i.shape)), 10);
-
-                c = c->previous.get();
+                i.get();
+            }
+            catch (...)
+            {
+                if (!failure)
+                    failure = std::current_exception();
             }
         }
-    };
 
-    auto backtrack = [&](MatrixCursor& cursor) -> bool {
-        backtrackCounter++;
-
-        auto pcpy = cursor.position;
-        auto backwards = backtrackCursor(cursor, cursor);
-        if (backwards)
-            forceDisconnect(matrix, pcpy, cursor.position);
-        else
-            return false;
-        return true;
-    };
-
-    // solve puzzle:
-    int activeCursor = 0;
-    int solC = 0;
-    while (!isSolution(matrix))
-    {
-        if (stepCounter % 10000 == 0)
+        for (auto const& i : results)
         {
-            std::cout << "Steps: " << stepCounter << " - Backtracks: " << backtrackCounter << "\n";
+            stepCounter += i.stepCounter;
+            backtrackCounter += i.backtrackCounter;
+            statistics.add(i.statistics);
         }
+        if (failure)
+            std::rethrow_exception(failure);
 
-        bool reached = true;
-        auto& nC = cursors[activeCursor];
-        for (;;)
+        // the shapes of a group keep their order on its board
+        std::vector <NodePath> pathes(matrix.getShapeCount());
+        bool interrupted = false;
+        for (std::size_t i = 0; i != groups.size(); ++i)
         {
-            bool r = false;
-            if (!makeStep(nC, nC) && !(r = hasReachedTarget(nC)) && !couldBeShapeSolution(matrix, nC.shape))
-                if (!backtrack(nC))
-                {
-                    reached = false;
-                    break;
-                }
-            if (r)
-                break;
+            for (std::size_t j = 0; j != groups[i].size() && j != results[i].pathes.size(); ++j)
+                pathes[groups[i][j]] = results[i].pathes[j];
+            interrupted = interrupted || results[i].interrupted;
         }
+        if (interrupted)
+            throw SolveInterrupted(budget->getStatus(), pathes);
+        return pathes;
+    }
+}
 
-        if (reached)
-            activeCursor++;
-        else
-        {
-            nC.stepBlackList.clear();
-            nC.stepBlackList.reserve(16);
-            activeCursor--;
-            if (activeCursor == -1)
-                throw std::runtime_error("No solution");
-            auto& tC = cursors[activeCursor];
-            if (!backtrack(tC))
-                throw std::runtime_error("No solution");
-        }
+std::vector <NodePath> LYNESolver::solve(long long& stepCounter, long long& backtrackCounter, SolveOptions const& options)
+{
+    // the board itself is never modified, the search keeps its own state.
+    statistics_ = SolveStatistics();
+    SolveBudget budget(options);
+    std::vector <NodePath> pathes;
+    auto groups = options.decompose ? findIndependentGroups(LYNEMatrix_) : std::vector <std::vector <int> > ();
+    if (groups.size() > 1)
+    {
+        std::vector <NodeMatrix> boards;
+        for (auto const& i : groups)
+            boards.push_back(extractGroup(LYNEMatrix_, i));
+        pathes = solveGroups(LYNEMatrix_, groups, boards, getGroupOracles(boards, options, &budget), options, &budget, stepCounter, backtrackCounter, statistics_);
+    }
+    else
+    {
+        pathes = solveBoard(LYNEMatrix_, options, getOracle(options, &budget), &budget, stepCounter, backtrackCounter, statistics_);
+    }
 
-        if (activeCursor == -1)
-            throw std::runtime_error("No solution");
+    //drawSolution(pathes);
+    //imshow("Solution", solutionDisplay_);
 
-        if (activeCursor == static_cast <int> (cursors.size()) && !isSolution(matrix))
-        {
-            activeCursor--; // reverse change
-            if (!backtrack(nC))
-            {
-                throw std::runtime_error("No solution");
-            }
-        }
+    return pathes;
+}
+
+SolveResult LYNESolver::trySolve(long long& stepCounter, long long& backtrackCounter, SolveOptions const& options)
+{
+    SolveResult result;
+    try
+    {
+        result.pathes = solve(stepCounter, backtrackCounter, options);
+        result.status = SolveStatus::Solved;
     }
+    catch (SolveInterrupted const& interruption)
+    {
+        result.status = interruption.getStatus();
+        result.pathes = interruption.getPartial();
+    }
+    catch (std::runtime_error const&)
+    {
+        result.status = SolveStatus::NoSolution;
+    }
+    return result;
+}
 
-    //drawSolution();
-    //imshow("Solution", solutionDisplay_);
+std::size_t LYNESolver::enumerate(long long& stepCounter, long long& backtrackCounter, SolutionCallback const& onSolution, std::size_t limit,
+                                  SolveOptions const& options)
+{
+    statistics_ = SolveStatistics();
+    SolveBudget budget(options);
+    EnumerateWithGeometry enumerateWith{LYNEMatrix_, options, stepCounter, backtrackCounter, statistics_, getOracle(options, &budget), &budget, onSolution, limit};
+    return withGeometry(LYNEMatrix_, enumerateWith);
+}
 
-    std::vector <NodePath> pathes;
-    for (auto const& i : cursors)
+bool LYNESolver::hasUniqueSolution(long long& stepCounter, long long& backtrackCounter, SolveOptions const& options)
+{
+    return enumerate(stepCounter, backtrackCounter, {}, 2, options) == 1;
+}
+
+namespace
+{
+    // of the time budget, the search gets what the oracle leaves
+    constexpr double oracleBudgetShare = 0.25;
+}
+
+HamiltonianOracle const* LYNESolver::getOracle(SolveOptions const& options, SolveBudget const* budget)
+{
+    if (options.oracleMaxCells <= 0)
+        return nullptr;
+
+    if (!oracle_ || oracleMaxCells_ != options.oracleMaxCells)
     {
-        NodePath path;
-        MatrixCursor const* c = &i;
-        path.push_back(matrix.get(c->position).position);
-        while (c->previous)
+        oracle_ = std::make_shared <HamiltonianOracle const> (LYNEMatrix_, options.oracleMaxCells, [budget]()
         {
-            c = c->previous.get();
-            path.push_back(matrix.get(c->position).position);
-        }
-        pathes.push_back(path);
+            return budget->isPastShare(oracleBudgetShare);
+        });
+
+        // a table cut short is only good for this solve
+        oracleMaxCells_ = oracle_->isComplete() ? options.oracleMaxCells : -1;
     }
+    return oracle_.get();
+}
+
+std::vector <HamiltonianOracle const*> LYNESolver::getGroupOracles(std::vector <NodeMatrix> const& boards, SolveOptions const& options,
+                                                                  SolveBudget const* budget)
+{
+    // the groups only depend on the board, so are the same for every solve
+    if (groupOracles_.size() != boards.size() || groupOracleMaxCells_ != options.oracleMaxCells)
+    {
+        auto stop = [budget]()
+        {
+            return budget->isPastShare(oracleBudgetShare);
+        };
 
+        groupOracles_.clear();
+        groupOracleMaxCells_ = options.oracleMaxCells;
+        for (auto const& i : boards)
+        {
+            groupOracles_.push_back(options.oracleMaxCells > 0 ? std::make_shared <HamiltonianOracle const> (i, options.oracleMaxCells, stop) : nullptr);
+            if (groupOracles_.back() && !groupOracles_.back()->isComplete())
+                groupOracleMaxCells_ = -1;
+        }
+    }
 
-    std::cout << "\n----------------------FINAL-------------------------\n";
-    std::cout << "Steps: " << stepCounter << " - Backtracks: " << backtrackCounter << "\n";
-    std::cout << "----------------------------------------------------\n";
+    std::vector <HamiltonianOracle const*> oracles;
+    for (auto const& i : groupOracles_)
+        oracles.push_back(i.get());
+    return oracles;
+}
 
-    return pathes;
+SolveStatistics LYNESolver::getStatistics() const
+{
+    return statistics_;
 }
@@ -1,29 +1,58 @@
 #ifndef LYNE_SOLVER_H_INCLUDED
 #define LYNE_SOLVER_H_INCLUDED
 
+#include "hamiltonian_oracle.h"
 #include "node_matrix.h"
 #include "path.h"
+#include "solve_budget.h"
+#include "solve_options.h"
+#include "solve_statistics.h"
 
+#include <functional>
+#include <memory>
 #include <type_traits>
 
 class LYNESolver
 {
 public:
     LYNESolver (NodeMatrix matrix, cv::Mat const& solutionDisplay = {});
-    std::vector <NodePath> solve(long long& stepCounter, long long& backtrackCounter);
+    // throws SolveInterrupted if the time budget, the step budget or the cancellation token of the options stopped it
+    std::vector <NodePath> solve(long long& stepCounter, long long& backtrackCounter, SolveOptions const& options = SolveOptions());
+
+    // like solve(), but reports how it ended instead of throwing. An interrupted solve
+    // returns the deepest partial state it reached, the caller may fall back on something else.
+    SolveResult trySolve(long long& stepCounter, long long& backtrackCounter, SolveOptions const& options = SolveOptions());
+
+    // returns false to stop the enumeration
+    using SolutionCallback = std::function <bool (std::vector <NodePath> const&)>;
+
+    // every distinct solution, until onSolution stops or limit of them were found (0 for no limit).
+    // Always searches with the cursor walk. Returns how many were found, throws SolveInterrupted
+    // if the budget of the options runs out first.
+    std::size_t enumerate(long long& stepCounter, long long& backtrackCounter, SolutionCallback const& onSolution, std::size_t limit = 0,
+                          SolveOptions const& options = SolveOptions());
+
+    // stops at the second solution, interrupted like enumerate
+    bool hasUniqueSolution(long long& stepCounter, long long& backtrackCounter, SolveOptions const& options = SolveOptions());
+
+    // of the last solve
+    SolveStatistics getStatistics() const;
 
 private:
-    bool isSolution(NodeMatrix const& mat);
-    bool couldBeShapeSolution(NodeMatrix const& mat, NodeShape shape);
-    bool canConnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2, NodeShape type);
-    bool tryConnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2, NodeShape type);
-    void forceConnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2, NodeShape type);
-    void forceDisconnect(NodeMatrix& matrix, MatrixPosition n1, MatrixPosition n2);
+    void drawSolution(std::vector <NodePath> const& paths);
+    // built once per board, the build gives up on its tables once it took its share of the budget
+    HamiltonianOracle const* getOracle(SolveOptions const& options, SolveBudget const* budget);
+    std::vector <HamiltonianOracle const*> getGroupOracles(std::vector <NodeMatrix> const& boards, SolveOptions const& options, SolveBudget const* budget);
 
 private:
     NodeMatrix LYNEMatrix_;
     cv::Mat orig_;
     cv::Mat solutionDisplay_;
+    SolveStatistics statistics_;
+    std::shared_ptr <HamiltonianOracle const> oracle_; // built by the first solve that wants it
+    int oracleMaxCells_;
+    std::vector <std::shared_ptr <HamiltonianOracle const> > groupOracles_; // per independent group of shapes
+    int groupOracleMaxCells_;
 };
 
 #endif // LYNE_SOLVER_H_INCLUDED
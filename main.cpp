@@ -1,3 +1,4 @@
+#include "batch_solver.h"
 #include "lyne_graph_generator.h"
 #include "lyne_solver.h"
 #include "magic_mouse.h"
@@ -33,6 +34,7 @@ enum class Operation
 bool loadSolution (fs::path where, std::vector <NodePath>& paths, std::pair <int, int>& resolution);
 void dumpPaths (fs::path where, std::vector <NodePath> const& paths, std::pair <int, int> resolution,
                 long long stepCounter, long long backtrackCounter);
+void printReport (long long stepCounter, long long backtrackCounter, SolveStatistics const& statistics);
 
 int main( int argc, char** argv )
 {
@@ -135,6 +137,7 @@ int main( int argc, char** argv )
 
                     LYNESolver solver(LYNEMatrix, gen.getOriginal().clone());
                     auto paths = solver.solve(stepCounter, backtrackCounter);
+                    printReport(stepCounter, backtrackCounter, solver.getStatistics());
 
                     auto filePath = setPath / fs::path(std::to_string(counter) + ".lyne");
                     dumpPaths (filePath, paths, res, stepCounter, backtrackCounter);
@@ -249,19 +252,29 @@ int main( int argc, char** argv )
 
     if (op == Operation::SolveAllOnly || op == Operation::SolveShots)
     {
+        // solve the whole set at once, it takes about as long as its hardest board.
+        std::vector <NodeMatrix> boards;
+        std::vector <int> counters;
         for (int counter = start; counter <= 25; ++counter)
         {
             if (matrices[counter - start].getWidth() == 0)
                 continue;
 
-            long long stepCounter = 0;
-            long long backtrackCounter = 0;
+            boards.push_back(matrices[counter - start]);
+            counters.push_back(counter);
+        }
 
-            LYNESolver solver(matrices[counter - start]);
-            auto paths = solver.solve(stepCounter, backtrackCounter);
+        auto results = solveBatch(boards);
+        for (std::size_t i = 0; i != results.size(); ++i)
+        {
+            if (!results[i].error.empty())
+            {
+                std::cout << counters[i] << ": " << results[i].error << "\n";
+                continue;
+            }
 
-            auto filePath = setPath / fs::path(std::to_string(counter) + ".lyne");
-            dumpPaths (filePath, paths, res, stepCounter, backtrackCounter);
+            auto filePath = setPath / fs::path(std::to_string(counters[i]) + ".lyne");
+            dumpPaths (filePath, results[i].paths, res, results[i].stepCounter, results[i].backtrackCounter);
         }
     }
 #else
@@ -280,6 +293,16 @@ void dumpPaths (fs::path where, std::vector <NodePath> const& paths, std::pair <
     saveSolutionToFile(where.string(), solution);
 }
 
+void printReport (long long stepCounter, long long backtrackCounter, SolveStatistics const& statistics)
+{
+    std::cout << "\n----------------------FINAL-------------------------\n";
+    std::cout << "Steps: " << stepCounter << " - Backtracks: " << backtrackCounter << "\n";
+    std::cout << "Transpositions: " << statistics.transpositionHits << " hits - " << statistics.transpositionMisses << " misses\n";
+    if (!statistics.portfolioWinner.empty())
+        std::cout << "Won by " << statistics.portfolioWinner << "\n";
+    std::cout << "----------------------------------------------------\n";
+}
+
 bool loadSolution (fs::path where, std::vector <NodePath>& paths, std::pair <int, int>& resolution)
 {
     auto solution = loadSolutionFromFile(where.string());
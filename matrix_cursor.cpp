@@ -1,68 +1,52 @@
 #include "matrix_cursor.h"
 
-MatrixCursor::MatrixCursor (MatrixPosition start, MatrixPosition target, NodeShape shape)
-    : position(start)
-    , start(start)
+MatrixCursor::MatrixCursor (CellIndex start, CellIndex target, NodeShape shape, int shapeIndex)
+    : start(start)
     , target(target)
     , shape(shape)
-    , previous()
-    , stepBlackList()
-{}
-
-MatrixCursor::MatrixCursor (MatrixPosition currentPosition, MatrixPosition start, MatrixPosition target, NodeShape shape)
-    : position(currentPosition)
-    , start(start)
-    , target(target)
-    , shape(shape)
-    , previous()
-    , stepBlackList()
+    , shapeIndex(shapeIndex)
+    , partner(-1)
+    , depth(0)
+    , path()
+    , tried()
+    , marks()
 {
-
+    path[0] = start;
 }
 
-MatrixCursor::MatrixCursor (
-    MatrixPosition position,
-    MatrixPosition start,
-    MatrixPosition target,
-    NodeShape shape,
-    std::shared_ptr <MatrixCursor> previous,
-    std::vector <MatrixPosition> stepBlackList
-)
-    : position(position)
-    , start(start)
-    , target(target)
-    , shape(shape)
-    , previous(previous)
-    , stepBlackList(stepBlackList)
+void decendCursor(MatrixCursor& cursor, CellIndex next, BoardState::TrailMark mark)
 {
+    ++cursor.depth;
+    cursor.path[cursor.depth] = next;
+    cursor.tried[cursor.depth] = 0;
+    cursor.marks[cursor.depth] = mark;
 }
 
-MatrixCursor decendCursor(MatrixCursor const& cursor, MatrixPosition newPosition)
+bool backtrackCursor(MatrixCursor& cursor)
 {
-    return {
-        newPosition,
-        cursor.start,
-        cursor.target,
-        cursor.shape,
-        std::shared_ptr <MatrixCursor> (new MatrixCursor{cursor}),
-        {
-            cursor.position // dont walk backwards, you silly
-        }
-    };
-}
-
-bool backtrackCursor(MatrixCursor const& cursor, MatrixCursor& backtracked)
-{
-    if (!cursor.previous.get())
+    // the step that lead here is already marked as tried in the parent.
+    if (cursor.depth == 0)
         return false;
 
-    MatrixCursor& c = *cursor.previous.get();
-    c.stepBlackList.push_back(cursor.position);
-    backtracked = c;
+    --cursor.depth;
     return true;
 }
 
+void resetCursor(MatrixCursor& cursor)
+{
+    cursor.depth = 0;
+    cursor.tried[0] = 0;
+}
+
 bool hasReachedTarget(MatrixCursor const& cursor)
 {
-    return cursor.target == cursor.position;
+    return cursor.target == cursor.position();
+}
+
+CellMask getVisitedCells(MatrixCursor const& cursor)
+{
+    CellMask visited = 0;
+    for (int i = 0; i <= cursor.depth; ++i)
+        visited |= cellBit(cursor.path[i]);
+    return visited;
 }
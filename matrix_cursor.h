@@ -2,34 +2,40 @@
 #define MATRIX_CURSOR_H_INCLUDED
 
 #include "node_matrix.h"
+#include "board_state.h"
 #include "node.h"
 
-#include <boost/optional.hpp>
-#include <memory>
+#include <array>
+#include <cstdint>
+
+// a path can pass valence restricted nodes more than once, but never uses an edge twice.
+constexpr int maxPathLength = maxMatrixEdges + 1;
 
 struct MatrixCursor
 {
-    MatrixPosition position;
-    MatrixPosition start;
-    MatrixPosition target;
+    CellIndex start;
+    CellIndex target; // follows the position of the partner, if there is one
     NodeShape shape;
-    std::shared_ptr <MatrixCursor> previous; // should be unique_ptr, buts this is just simpler.
-    std::vector <MatrixPosition> stepBlackList;
-
-    MatrixCursor (MatrixPosition start, MatrixPosition target, NodeShape shape);
-    MatrixCursor (MatrixPosition currentPosition, MatrixPosition start, MatrixPosition target, NodeShape shape);
-    MatrixCursor (
-        MatrixPosition position,
-        MatrixPosition start,
-        MatrixPosition target,
-        NodeShape shape,
-        std::shared_ptr <MatrixCursor> previous,
-        std::vector <MatrixPosition> stepBlackList
-    );
+    int shapeIndex; // of shape in NodeMatrix::getShapeList()
+    int partner; // cursor growing the same path from the other end, -1 if none
+
+    int depth; // path[depth] is the current position
+    std::array <CellIndex, maxPathLength> path;
+    std::array <std::uint8_t, maxPathLength> tried; // directions already tried from path[depth]
+    std::array <BoardState::TrailMark, maxPathLength> marks; // trail before the step to path[depth]
+
+    MatrixCursor (CellIndex start, CellIndex target, NodeShape shape, int shapeIndex);
+
+    inline CellIndex position() const
+    {
+        return path[depth];
+    }
 };
 
-MatrixCursor decendCursor(MatrixCursor const& cursor, MatrixPosition newPosition);
-bool backtrackCursor(MatrixCursor const& cursor, MatrixCursor& backtracked);
+void decendCursor(MatrixCursor& cursor, CellIndex next, BoardState::TrailMark mark);
+bool backtrackCursor(MatrixCursor& cursor);
+void resetCursor(MatrixCursor& cursor);
 bool hasReachedTarget(MatrixCursor const& cursor);
+CellMask getVisitedCells(MatrixCursor const& cursor);
 
 #endif // MATRIX_CURSOR_H_INCLUDED
@@ -0,0 +1,73 @@
+#include "move_ordering.h"
+
+namespace
+{
+    inline bool isCompatible(NodeShape cellShape, NodeShape shape)
+    {
+        return cellShape == shape || cellShape == NodeShape::ValenceRestricted;
+    }
+}
+
+int countOnwardOptions(BoardState const& state, CellIndex cell, NodeShape shape, EdgeIndex arrival)
+{
+    auto const& board = state.getBoard();
+
+    int options = 0;
+    for (auto const& neighbour : board.getNeighbours(cell))
+    {
+        if (neighbour.edge == arrival)
+            continue;
+
+        if (state.isPending(neighbour.edge))
+        {
+            if (state.getEdgeShape(neighbour.edge) == shape)
+                ++options;
+            continue;
+        }
+
+        if (state.isConnected(neighbour.edge) || state.getRemainingValence(neighbour.cell) == 0)
+            continue;
+
+        auto crossing = board.getCrossingEdge(neighbour.edge);
+        if (crossing != -1 && state.isConnected(crossing))
+            continue;
+
+        if (isCompatible(board.getShape(neighbour.cell), shape))
+            ++options;
+    }
+    return options;
+}
+
+MoveOrderer::MoveOrderer (MoveOrdering ordering, unsigned seed)
+    : ordering_(ordering)
+    , random_(seed)
+{
+}
+
+int MoveOrderer::score(BoardState const& state, MatrixCursor const& cursor, Neighbour const& next)
+{
+    switch (ordering_)
+    {
+        case MoveOrdering::FewestOptions:
+            return countOnwardOptions(state, next.cell, cursor.shape, next.edge);
+        case MoveOrdering::DeadEndFirst:
+        {
+            // options the cell has to spare once the step took one of its connections.
+            auto remaining = state.getRemainingValence(next.cell) - (state.isPending(next.edge) ? 0 : 1);
+            return countOnwardOptions(state, next.cell, cursor.shape, next.edge) - remaining;
+        }
+        case MoveOrdering::TowardsTarget:
+        {
+            auto const& board = state.getBoard();
+            auto open = board.getShapeCells(cursor.shapeIndex) & state.getOpenCells() & ~cellBit(cursor.position()) & ~cellBit(cursor.target);
+            if (open != 0 || state.getPendingCount(cursor.shapeIndex) != 0)
+                return 0;
+            return board.getDistance(next.cell, cursor.target);
+        }
+        case MoveOrdering::Random:
+            return static_cast <int> (random_() >> 1);
+        case MoveOrdering::Fixed:
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef MOVE_ORDERING_H_INCLUDED
+#define MOVE_ORDERING_H_INCLUDED
+
+#include "board_state.h"
+#include "matrix_cursor.h"
+#include "solve_options.h"
+
+#include <random>
+
+/**
+ *  Scores the candidate steps of a cursor, lower scores are tried first.
+ *  Equal scores keep the direction order, so MoveOrdering::Fixed scores everything the same.
+ */
+class MoveOrderer
+{
+public:
+    MoveOrderer (MoveOrdering ordering, unsigned seed);
+
+    inline MoveOrdering getOrdering() const
+    {
+        return ordering_;
+    }
+
+    int score(BoardState const& state, MatrixCursor const& cursor, Neighbour const& next);
+
+private:
+    MoveOrdering ordering_;
+    std::mt19937 random_;
+};
+
+// steps a path of the shape could take from the cell, not counting the edge it arrived on.
+int countOnwardOptions(BoardState const& state, CellIndex cell, NodeShape shape, EdgeIndex arrival);
+
+#endif // MOVE_ORDERING_H_INCLUDED
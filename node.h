@@ -17,13 +17,12 @@ enum class NodeShape
 cv::Vec4b ShapeToVector(NodeShape shape);
 NodeShape ShapeFromVector(cv::Vec4b const& vect);
 
+// a recognized node, the NodeMatrix keeps these in flat arrays instead.
 struct Node
 {
     cv::Point position = {};
     NodeShape shape = NodeShape::Nothing;
     int requiredValence = 0;
-    int valence = 0;
-    std::vector <std::pair <Node*, NodeShape> > connections;
 };
 
 #endif // NODE_H_INCLUDED
@@ -1,68 +1,241 @@
 #include "node_matrix.h"
 
-NodeMatrix::NodeMatrix (std::vector <std::vector <Node> > nodes)
-    : nodes_(nodes)
+#include <algorithm>
+#include <stdexcept>
+
+NodeMatrix::NodeMatrix ()
+    : width_(0)
+    , height_(0)
+    , shapes_()
+    , requiredValences_()
+    , shapeIndices_()
+    , edgeTable_()
+    , crossingTable_()
+    , edgeCells_()
+    , neighbours_()
+    , neighbourCounts_()
+    , neighbourMasks_()
+    , neighbourCells_()
+    , nodeCells_(0)
+    , shapeCells_()
+    , restrictedCells_(0)
+    , allCells_(0)
+    , notFirstColumn_(0)
+    , notLastColumn_(0)
+    , shapeList_()
+    , pixelPositions_()
 {
 }
 
-std::vector <NodeShape> NodeMatrix::getShapeList() const
+NodeMatrix::NodeMatrix (int width, int height, std::vector <Node> const& cells)
+    : width_(width)
+    , height_(height)
+    , shapes_(cells.size(), NodeShape::Nothing)
+    , requiredValences_(cells.size(), 0)
+    , shapeIndices_(cells.size(), -1)
+    , edgeTable_()
+    , crossingTable_()
+    , edgeCells_()
+    , neighbours_()
+    , neighbourCounts_()
+    , neighbourMasks_()
+    , neighbourCells_()
+    , nodeCells_(0)
+    , shapeCells_()
+    , restrictedCells_(0)
+    , allCells_(0)
+    , notFirstColumn_(0)
+    , notLastColumn_(0)
+    , shapeList_()
+    , pixelPositions_(cells.size())
+{
+    if (static_cast <int> (cells.size()) != width * height)
+        throw std::invalid_argument("cell count does not match the matrix dimensions");
+    if (width * height > maxMatrixCells)
+        throw std::invalid_argument("matrix is too large");
+
+    for (std::size_t i = 0; i != cells.size(); ++i)
+    {
+        shapes_[i] = cells[i].shape;
+        requiredValences_[i] = static_cast <std::uint8_t> (cells[i].requiredValence);
+        pixelPositions_[i] = cells[i].position;
+    }
+
+    buildShapeTables();
+    buildEdgeTables();
+    buildNeighbourTables();
+}
+
+void NodeMatrix::buildShapeTables()
 {
-    std::vector <NodeShape> shapes;
-    for (auto const& i : nodes_)
+    // column by column, the cursor order of the solver depends on it.
+    for (MatrixPosition::value_type x = 0; x != width_; ++x)
     {
-        for (auto const& j : i)
+        for (MatrixPosition::value_type y = 0; y != height_; ++y)
         {
-            if (std::find(std::begin(shapes), std::end(shapes), j.shape) == std::end(shapes))
-                if (j.shape != NodeShape::ValenceRestricted && j.shape != NodeShape::Nothing)
-                    shapes.push_back(j.shape);
+            auto shape = shapes_[getIndex({x, y})];
+            if (std::find(std::begin(shapeList_), std::end(shapeList_), shape) == std::end(shapeList_))
+                if (shape != NodeShape::ValenceRestricted && shape != NodeShape::Nothing)
+                    shapeList_.push_back(shape);
         }
     }
-    return shapes;
+
+    for (CellIndex cell = 0; cell != getCellCount(); ++cell)
+        shapeIndices_[cell] = static_cast <std::int8_t> (getShapeIndex(shapes_[cell]));
 }
 
-boost::optional <std::pair <MatrixPosition, MatrixPosition> > NodeMatrix::getStartEndPair(NodeShape shape) const
+void NodeMatrix::buildEdgeTables()
 {
-    std::vector <MatrixPosition> epa;
+    edgeTable_.assign(getCellCount() * DirectionCount, -1);
+    crossingTable_.assign(getEdgeCount(), -1);
+    edgeCells_.assign(getEdgeCount(), std::make_pair (-1, -1));
+
+    auto isInside = [this](MatrixPosition::value_type x, MatrixPosition::value_type y) {
+        return x >= 0 && x < width_ && y >= 0 && y < height_;
+    };
 
-    for (MatrixPosition::value_type i = 0; i != static_cast <MatrixPosition::value_type> (nodes_.size()); ++i)
+    for (CellIndex cell = 0; cell != getCellCount(); ++cell)
     {
-        for (MatrixPosition::value_type j = 0; j != static_cast <MatrixPosition::value_type> (nodes_[i].size()); ++j)
+        auto position = getMatrixPosition(cell);
+        for (int direction = East; direction != DirectionCount; ++direction)
         {
-            if (nodes_[i][j].shape == shape && nodes_[i][j].requiredValence == 1)
-            {
-                epa.push_back(MatrixPosition{i, j});
+            auto x = position.x + directionX[direction];
+            auto y = position.y + directionY[direction];
+            if (!isInside(x, y))
+                continue;
 
-                if (epa.size() == 2)
-                    return {std::make_pair (epa[0], epa[1])};
-            }
+            auto neighbour = getIndex({x, y});
+            EdgeIndex edge = cell * 4 + (direction - East);
+            edgeTable_[cell * DirectionCount + direction] = edge;
+            edgeTable_[neighbour * DirectionCount + oppositeDirection(direction)] = edge;
+            edgeCells_[edge] = std::make_pair (cell, neighbour);
         }
     }
-    return boost::none;
+
+    // south east of (x, y) crosses south west of (x + 1, y)
+    for (CellIndex cell = 0; cell != getCellCount(); ++cell)
+    {
+        auto southEast = getEdge(cell, SouthEast);
+        if (southEast == -1)
+            continue;
+
+        auto southWest = getEdge(cell + 1, SouthWest);
+        crossingTable_[southEast] = southWest;
+        crossingTable_[southWest] = southEast;
+    }
 }
 
-std::vector <MatrixPosition> NodeMatrix::getAdjacent(MatrixPosition const& origin, std::vector <MatrixPosition> const& blackList) const
+namespace
 {
-    // cannot be
-    //if (!isNode(origin))
-    //    throw std::runtime_error ("Origin is not a node, therefore this request is invalid");
+    std::vector <Node> flatten(std::vector <std::vector <Node> > const& nodes)
+    {
+        std::vector <Node> cells;
+        if (nodes.empty())
+            return cells;
+
+        auto width = nodes.size();
+        auto height = nodes[0].size();
+        cells.resize(width * height);
+        for (std::size_t x = 0; x != width; ++x)
+            for (std::size_t y = 0; y != height; ++y)
+                cells[y * width + x] = nodes[x][y];
+        return cells;
+    }
+}
 
-    std::vector <MatrixPosition> pos;
+NodeMatrix::NodeMatrix (std::vector <std::vector <Node> > const& nodes)
+    : NodeMatrix(
+        static_cast <int> (nodes.size()),
+        nodes.empty() ? 0 : static_cast <int> (nodes[0].size()),
+        flatten(nodes)
+    )
+{
+}
 
-    auto addIfExists = [&, this](MatrixPosition p) {
-        if (isNode(p) && std::find(std::begin(blackList), std::end(blackList), p) == std::end(blackList))
-            pos.push_back(p);
-    };
+void NodeMatrix::buildNeighbourTables()
+{
+    neighbours_.assign(getCellCount() * DirectionCount, Neighbour{-1, -1, -1});
+    neighbourCounts_.assign(getCellCount(), 0);
+    neighbourMasks_.assign(getCellCount(), 0);
+    neighbourCells_.assign(getCellCount(), 0);
+    shapeCells_.assign(shapeList_.size(), 0);
 
-    addIfExists({origin.x - 1, origin.y - 1});
-    addIfExists({origin.x    , origin.y - 1});
-    addIfExists({origin.x + 1, origin.y - 1});
+    for (CellIndex cell = 0; cell != getCellCount(); ++cell)
+    {
+        if (shapes_[cell] != NodeShape::Nothing)
+            nodeCells_ |= cellBit(cell);
+        if (shapes_[cell] == NodeShape::ValenceRestricted)
+            restrictedCells_ |= cellBit(cell);
+        if (shapeIndices_[cell] != -1)
+            shapeCells_[shapeIndices_[cell]] |= cellBit(cell);
 
-    addIfExists({origin.x - 1, origin.y    });
-    addIfExists({origin.x + 1, origin.y    });
+        auto position = getMatrixPosition(cell);
+        allCells_ |= cellBit(cell);
+        if (position.x != 0)
+            notFirstColumn_ |= cellBit(cell);
+        if (position.x != width_ - 1)
+            notLastColumn_ |= cellBit(cell);
 
-    addIfExists({origin.x - 1, origin.y + 1});
-    addIfExists({origin.x    , origin.y + 1});
-    addIfExists({origin.x + 1, origin.y + 1});
+        for (int direction = 0; direction != DirectionCount; ++direction)
+        {
+            MatrixPosition next = {position.x + directionX[direction], position.y + directionY[direction]};
+            if (!isNode(next))
+                continue;
 
-    return pos;
+            neighbours_[cell * DirectionCount + neighbourCounts_[cell]] = {getIndex(next), getEdge(cell, direction), direction};
+            ++neighbourCounts_[cell];
+            neighbourMasks_[cell] |= static_cast <std::uint8_t> (1u << direction);
+            neighbourCells_[cell] |= cellBit(getIndex(next));
+        }
+    }
+}
+
+Node NodeMatrix::get(MatrixPosition position) const
+{
+    auto cell = getIndex(position);
+
+    Node node;
+    node.position = pixelPositions_[cell];
+    node.shape = shapes_[cell];
+    node.requiredValence = requiredValences_[cell];
+    return node;
+}
+
+std::vector <NodeShape> NodeMatrix::getShapeList() const
+{
+    return shapeList_;
+}
+
+int NodeMatrix::getShapeCount() const
+{
+    return static_cast <int> (shapeList_.size());
+}
+
+int NodeMatrix::getShapeIndex(NodeShape shape) const
+{
+    auto iter = std::find(std::begin(shapeList_), std::end(shapeList_), shape);
+    if (iter == std::end(shapeList_))
+        return -1;
+    return static_cast <int> (std::distance(std::begin(shapeList_), iter));
+}
+
+boost::optional <std::pair <MatrixPosition, MatrixPosition> > NodeMatrix::getStartEndPair(NodeShape shape) const
+{
+    std::vector <MatrixPosition> epa;
+
+    for (MatrixPosition::value_type x = 0; x != width_; ++x)
+    {
+        for (MatrixPosition::value_type y = 0; y != height_; ++y)
+        {
+            auto cell = getIndex({x, y});
+            if (shapes_[cell] == shape && requiredValences_[cell] == 1)
+            {
+                epa.push_back(MatrixPosition{x, y});
+
+                if (epa.size() == 2)
+                    return {std::make_pair (epa[0], epa[1])};
+            }
+        }
+    }
+    return boost::none;
 }
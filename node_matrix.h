@@ -5,6 +5,10 @@
 
 #include <boost/optional.hpp>
 
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+
 struct MatrixPosition
 {
     using value_type = std::make_signed <std::size_t>::type;
@@ -26,13 +30,171 @@ inline bool operator!= (MatrixPosition const& lhs, MatrixPosition const& rhs)
     return lhs.x != rhs.x || lhs.y != rhs.y;
 }
 
+// cells are numbered row by row: index = y * width + x
+using CellIndex = int;
+
+// every cell owns the edges to its east, south west, south and south east neighbour:
+// edge = cell * 4 + (direction - East)
+using EdgeIndex = int;
+
+constexpr int maxMatrixCells = 64;
+constexpr int maxMatrixEdges = 4 * maxMatrixCells;
+
+using EdgeSet = std::bitset <maxMatrixEdges>;
+
+// one bit per cell
+using CellMask = std::uint64_t;
+
+inline CellMask cellBit(CellIndex cell)
+{
+    return CellMask{1} << cell;
+}
+
+// removes the lowest cell from the mask and returns it
+inline CellIndex popCell(CellMask& cells)
+{
+    auto cell = static_cast <CellIndex> (__builtin_ctzll(cells));
+    cells &= cells - 1;
+    return cell;
+}
+
+// neighbour directions in the order the solver tries them, opposite direction = 7 - direction
+enum Direction
+{
+    NorthWest = 0,
+    North,
+    NorthEast,
+    West,
+    East,
+    SouthWest,
+    South,
+    SouthEast,
+    DirectionCount
+};
+
+constexpr int directionX[DirectionCount] = {-1,  0,  1, -1,  1, -1,  0,  1};
+constexpr int directionY[DirectionCount] = {-1, -1, -1,  0,  0,  1,  1,  1};
+
+constexpr int oppositeDirection(int direction)
+{
+    return DirectionCount - 1 - direction;
+}
+
+// -1 if the offset does not point to a neighbour
+inline int directionFromOffset(MatrixPosition::value_type dx, MatrixPosition::value_type dy)
+{
+    if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || (dx == 0 && dy == 0))
+        return -1;
+    auto index = static_cast <int> ((dy + 1) * 3 + (dx + 1));
+    return index < 4 ? index : index - 1;
+}
+
+struct Neighbour
+{
+    CellIndex cell;
+    EdgeIndex edge;
+    int direction;
+};
+
+// walks the neighbours of a cell, skipping all directions in the excluded mask.
+class NeighbourRange
+{
+public:
+    class iterator
+    {
+    public:
+        iterator (Neighbour const* current, Neighbour const* end, std::uint8_t excluded)
+            : current_(current)
+            , end_(end)
+            , excluded_(excluded)
+        {
+            skip();
+        }
+
+        inline Neighbour const& operator*() const
+        {
+            return *current_;
+        }
+
+        inline Neighbour const* operator->() const
+        {
+            return current_;
+        }
+
+        inline iterator& operator++()
+        {
+            ++current_;
+            skip();
+            return *this;
+        }
+
+        inline bool operator!=(iterator const& other) const
+        {
+            return current_ != other.current_;
+        }
+
+        inline bool operator==(iterator const& other) const
+        {
+            return current_ == other.current_;
+        }
+
+    private:
+        inline void skip()
+        {
+            while (current_ != end_ && (excluded_ & (1u << current_->direction)))
+                ++current_;
+        }
+
+        Neighbour const* current_;
+        Neighbour const* end_;
+        std::uint8_t excluded_;
+    };
+
+    NeighbourRange (Neighbour const* first, Neighbour const* last, std::uint8_t excluded)
+        : first_(first)
+        , last_(last)
+        , excluded_(excluded)
+    {
+    }
+
+    inline iterator begin() const
+    {
+        return {first_, last_, excluded_};
+    }
+
+    inline iterator end() const
+    {
+        return {last_, last_, excluded_};
+    }
+
+private:
+    Neighbour const* first_;
+    Neighbour const* last_;
+    std::uint8_t excluded_;
+};
+
 class NodeMatrix
 {
 public:
-    NodeMatrix (std::vector <std::vector <Node> > nodes);
+    NodeMatrix ();
+    NodeMatrix (int width, int height, std::vector <Node> const& cells); // cells in row order
+    NodeMatrix (std::vector <std::vector <Node> > const& nodes); // nodes[x][y]
+
     std::vector <NodeShape> getShapeList() const;
+    int getShapeCount() const;
+
+    // position of the shape in getShapeList(), -1 for valence restricted nodes and holes.
+    // A linear search, hot paths look up the index of a cell or keep the index instead.
+    int getShapeIndex(NodeShape shape) const;
+
+    inline NodeShape getIndexedShape(int shapeIndex) const
+    {
+        return shapeList_[shapeIndex];
+    }
     boost::optional <std::pair <MatrixPosition, MatrixPosition> > getStartEndPair(NodeShape shape) const;
-    std::vector <MatrixPosition> getAdjacent(MatrixPosition const& origin, std::vector <MatrixPosition> const& blackList) const;
+
+    // assembles a copy of a node, not meant for the solver.
+    Node get(MatrixPosition position) const;
 
     inline bool isNode(MatrixPosition position) const
     {
@@ -41,41 +203,166 @@ public:
         if (position.y >= getHeight() || position.y < 0)
             return false;
 
-        return get(position).shape != NodeShape::Nothing;
+        return shapes_[getIndex(position)] != NodeShape::Nothing;
     }
 
     inline int getWidth() const
     {
-        return static_cast <int> (nodes_.size());
+        return width_;
     }
 
     inline int getHeight() const
     {
-        return static_cast <int> (nodes_[0].size());
+        return height_;
     }
 
-    inline Node& get(MatrixPosition position)
+    inline int getCellCount() const
     {
-        return nodes_[position.x][position.y];
+        return width_ * height_;
     }
 
-    inline Node get(MatrixPosition position) const
+    inline CellIndex getIndex(MatrixPosition position) const
     {
-        return nodes_[position.x][position.y];
+        return static_cast <CellIndex> (position.y * width_ + position.x);
     }
 
-    inline std::vector <std::vector <Node> >& getNodes()
+    inline MatrixPosition getMatrixPosition(CellIndex cell) const
     {
-        return nodes_;
+        return {cell % width_, cell / width_};
     }
 
-    inline std::vector <std::vector <Node> > const& getNodes() const
+    // number of king moves between both cells
+    inline int getDistance(CellIndex cell1, CellIndex cell2) const
     {
-        return nodes_;
+        auto dx = std::abs(cell1 % width_ - cell2 % width_);
+        auto dy = std::abs(cell1 / width_ - cell2 / width_);
+        return dx > dy ? dx : dy;
     }
 
+    inline NodeShape getShape(CellIndex cell) const
+    {
+        return shapes_[cell];
+    }
+
+    inline int getShapeIndex(CellIndex cell) const
+    {
+        return shapeIndices_[cell];
+    }
+
+    inline int getRequiredValence(CellIndex cell) const
+    {
+        return requiredValences_[cell];
+    }
+
+    inline int getEdgeCount() const
+    {
+        return 4 * getCellCount();
+    }
+
+    // -1 if the neighbour is outside of the matrix
+    inline EdgeIndex getEdge(CellIndex cell, int direction) const
+    {
+        return edgeTable_[cell * DirectionCount + direction];
+    }
+
+    // neighbouring nodes only, in direction order. Computed once per matrix.
+    inline NeighbourRange getNeighbours(CellIndex cell, std::uint8_t excludedDirections = 0) const
+    {
+        auto first = neighbours_.data() + cell * DirectionCount;
+        return {first, first + neighbourCounts_[cell], excludedDirections};
+    }
+
+    inline std::uint8_t getNeighbourMask(CellIndex cell) const
+    {
+        return neighbourMasks_[cell];
+    }
+
+    inline CellMask getNeighbourCells(CellIndex cell) const
+    {
+        return neighbourCells_[cell];
+    }
+
+    inline CellMask getNodeCells() const
+    {
+        return nodeCells_;
+    }
+
+    inline CellMask getShapeCells(int shapeIndex) const
+    {
+        return shapeCells_[shapeIndex];
+    }
+
+    inline CellMask getValenceRestrictedCells() const
+    {
+        return restrictedCells_;
+    }
+
+    // adds all neighbouring cells to the mask at once, holes included.
+    inline CellMask growCells(CellMask cells) const
+    {
+        auto row = cells | ((cells & notLastColumn_) << 1) | ((cells & notFirstColumn_) >> 1);
+        return (row | (row << width_) | (row >> width_)) & allCells_;
+    }
+
+    inline EdgeIndex getEdge(MatrixPosition n1, MatrixPosition n2) const
+    {
+        auto direction = directionFromOffset(n2.x - n1.x, n2.y - n1.y);
+        if (direction == -1 || n1.x < 0 || n1.x >= width_ || n1.y < 0 || n1.y >= height_)
+            return -1;
+        return getEdge(getIndex(n1), direction);
+    }
+
+    // the diagonal that crosses the given diagonal edge, -1 for straight edges
+    inline EdgeIndex getCrossingEdge(EdgeIndex edge) const
+    {
+        return crossingTable_[edge];
+    }
+
+    inline std::pair <CellIndex, CellIndex> getEdgeCells(EdgeIndex edge) const
+    {
+        return edgeCells_[edge];
+    }
+
+
+    inline cv::Point getPixelPosition(CellIndex cell) const
+    {
+        return pixelPositions_[cell];
+    }
+
+private:
+    void buildShapeTables();
+    void buildEdgeTables();
+    void buildNeighbourTables();
+
 private:
-    std::vector <std::vector <Node> /* one line */> nodes_;
+    int width_;
+    int height_;
+
+    // search data, kept tight. The state of a search lives in a BoardState.
+    std::vector <NodeShape> shapes_;
+    std::vector <std::uint8_t> requiredValences_;
+    std::vector <std::int8_t> shapeIndices_;
+
+    std::vector <EdgeIndex> edgeTable_;
+    std::vector <EdgeIndex> crossingTable_;
+    std::vector <std::pair <CellIndex, CellIndex> > edgeCells_;
+
+    std::vector <Neighbour> neighbours_; // DirectionCount slots per cell
+    std::vector <std::uint8_t> neighbourCounts_;
+    std::vector <std::uint8_t> neighbourMasks_;
+    std::vector <CellMask> neighbourCells_;
+    CellMask nodeCells_;
+
+    std::vector <CellMask> shapeCells_;
+    CellMask restrictedCells_;
+    CellMask allCells_;
+    CellMask notFirstColumn_;
+    CellMask notLastColumn_;
+
+    std::vector <NodeShape> shapeList_;
+
+    // only needed to output the solution.
+    std::vector <cv::Point> pixelPositions_;
 };
 
 #endif // NODE_MATRIX_H_INCLUDED
@@ -0,0 +1,33 @@
+#include "nogood_store.h"
+
+NogoodStore::NogoodStore (std::size_t capacity)
+    : capacity_(capacity)
+    , nogoods_()
+    , byEdge_(maxMatrixEdges)
+{
+}
+
+void NogoodStore::add(Nogood nogood)
+{
+    if (nogood.edges.empty())
+        return;
+
+    if (nogoods_.size() == capacity_)
+        clear();
+
+    auto index = static_cast <int> (nogoods_.size());
+    nogood.edgeSet.reset();
+    for (auto const& i : nogood.edges)
+    {
+        nogood.edgeSet.set(i.first);
+        byEdge_[i.first].push_back(index);
+    }
+    nogoods_.push_back(std::move(nogood));
+}
+
+void NogoodStore::clear()
+{
+    nogoods_.clear();
+    for (auto& i : byEdge_)
+        i.clear();
+}
@@ -0,0 +1,72 @@
+#ifndef NOGOOD_STORE_H_INCLUDED
+#define NOGOOD_STORE_H_INCLUDED
+
+#include "node_matrix.h"
+
+#include <bitset>
+#include <utility>
+#include <vector>
+
+// one bit per decision of the search, the decision level is its position on the decision stack.
+using LevelSet = std::bitset <maxMatrixEdges>;
+
+// a cursor after exactly depth steps, standing on position
+struct NogoodHead
+{
+    int cursor;
+    CellIndex position;
+    int depth;
+};
+
+/**
+ *  A combination of steps that is known to fail: every edge walked with the given shape,
+ *  every listed cursor where its head says. A path through valence restricted nodes
+ *  can come back to the same cell, so the depth is part of the head.
+ */
+struct Nogood
+{
+    std::vector <std::pair <EdgeIndex, NodeShape> > edges;
+    std::vector <NogoodHead> heads;
+    EdgeSet edgeSet; // the same edges, for a quick test
+};
+
+/**
+ *  Learned nogoods, looked up by the edges they contain.
+ *  The store is bounded, it starts over once it is full.
+ */
+class NogoodStore
+{
+public:
+    explicit NogoodStore (std::size_t capacity = 4096);
+
+    void add(Nogood nogood);
+    void clear();
+
+    // indices of the nogoods containing the edge
+    inline std::vector <int> const& getCandidates(EdgeIndex edge) const
+    {
+        return byEdge_[edge];
+    }
+
+    inline Nogood const& get(int index) const
+    {
+        return nogoods_[index];
+    }
+
+    inline std::size_t size() const
+    {
+        return nogoods_.size();
+    }
+
+    inline std::size_t getCapacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    std::size_t capacity_;
+    std::vector <Nogood> nogoods_;
+    std::vector <std::vector <int> > byEdge_;
+};
+
+#endif // NOGOOD_STORE_H_INCLUDED
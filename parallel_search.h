@@ -0,0 +1,139 @@
+#ifndef PARALLEL_SEARCH_H_INCLUDED
+#define PARALLEL_SEARCH_H_INCLUDED
+
+#include "cursor_search.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace parallel_search_detail
+{
+    constexpr std::size_t subtreesPerThread = 8;
+    constexpr int maxSplitDepth = 24;
+}
+
+/**
+ *  The cursor search of one board on several threads. The tree is cut at the shallowest
+ *  depth that gives every thread several subtrees, each subtree is searched by a
+ *  CursorSearch of its own on a WorkStealingPool. The first solution cancels the others.
+ */
+// the thread count of the options, 0 for every core
+inline unsigned getThreadCount(SolveOptions const& options)
+{
+    return options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// cuts the tree at the shallowest depth that gives every thread several subtrees.
+// True if the search ended above that depth instead, with its result in pathes.
+template <typename Geometry>
+bool splitSearch(NodeMatrix const& board, Geometry geometry, SolveOptions const& options, HamiltonianOracle const* oracle, SolveBudget* budget,
+                 long long& stepCounter, long long& backtrackCounter, SolveStatistics& statistics,
+                 typename CursorSearch <Geometry>::SolutionCallback const& onSolution,
+                 std::vector <typename CursorSearch <Geometry>::Prefix>& prefixes, std::vector <NodePath>& pathes)
+{
+    using namespace parallel_search_detail;
+
+    for (int depth = 1; ; ++depth)
+    {
+        prefixes.clear();
+        CursorSearch <Geometry> split(board, geometry, options, stepCounter, backtrackCounter, statistics, oracle);
+        split.setSplitDepth(depth, &prefixes);
+        split.setBudget(budget);
+        if (onSolution)
+            split.setSolutionCallback(onSolution);
+        bool ended = true;
+        try
+        {
+            pathes = split.run();
+        }
+        catch (std::runtime_error const&)
+        {
+            // every node of the depth was handed out
+            ended = false;
+        }
+
+        if (split.isCancelled())
+            budget->interrupt();
+        if (ended)
+            return true;
+
+        if (prefixes.empty() || prefixes.size() >= subtreesPerThread * getThreadCount(options) || depth == maxSplitDepth)
+            return false;
+    }
+}
+
+template <typename Geometry>
+std::vector <NodePath> runParallelSearch(NodeMatrix const& board, Geometry geometry, SolveOptions const& options, HamiltonianOracle const* oracle,
+                                         SolveBudget* budget, long long& stepCounter, long long& backtrackCounter, SolveStatistics& statistics)
+{
+    using Search = CursorSearch <Geometry>;
+    using Prefix = typename Search::Prefix;
+
+    auto threads = getThreadCount(options);
+
+    std::vector <Prefix> prefixes;
+    std::vector <NodePath> result;
+    if (splitSearch(board, geometry, options, oracle, budget, stepCounter, backtrackCounter, statistics, {}, prefixes, result))
+        return result;
+    if (prefixes.empty())
+        throw std::runtime_error("No solution");
+
+    std::atomic <bool> found(false);
+    std::mutex resultMutex;
+    std::vector <WorkerCounters> counters(threads);
+
+    std::vector <WorkStealingPool::Task> tasks;
+    for (auto const& prefix : prefixes)
+    {
+        tasks.push_back([&, prefix](unsigned worker)
+        {
+            if (found.load(std::memory_order_relaxed) || (budget != nullptr && budget->isExhausted()))
+                return;
+
+            auto& counter = counters[worker];
+            Search search(board, geometry, options, counter.stepCounter, counter.backtrackCounter, counter.statistics, oracle);
+            search.setPrefix(prefix);
+            search.setCancelFlag(&found);
+            search.setBudget(budget);
+            try
+            {
+                auto pathes = search.run();
+                if (search.isCancelled())
+                    return;
+
+                std::lock_guard <std::mutex> lock(resultMutex);
+                if (!found.exchange(true))
+                    result = pathes;
+            }
+            catch (std::runtime_error const&)
+            {
+                // nothing in this subtree
+            }
+        });
+    }
+
+    WorkStealingPool pool(threads);
+    pool.run(std::move(tasks));
+
+    for (auto const& i : counters)
+    {
+        stepCounter += i.stepCounter;
+        backtrackCounter += i.backtrackCounter;
+        statistics.add(i.statistics);
+    }
+
+    if (!found)
+    {
+        if (budget != nullptr && budget->isExhausted())
+            budget->interrupt();
+        throw std::runtime_error("No solution");
+    }
+    return result;
+}
+
+#endif // PARALLEL_SEARCH_H_INCLUDED
@@ -0,0 +1,28 @@
+#include "path_bounds.h"
+
+#include <algorithm>
+
+int getMinimumPathLength(BoardState const& state, int shapeIndex, CellIndex position, CellIndex target)
+{
+    auto const& board = state.getBoard();
+
+    auto visits = board.getShapeCells(shapeIndex) & state.getOpenCells() & ~cellBit(position);
+
+    auto length = std::max(__builtin_popcountll(visits), state.getPendingCount(shapeIndex));
+    length = std::max(length, board.getDistance(position, target));
+
+    // the path has to make a detour over every node it still has to visit.
+    while (visits)
+    {
+        auto cell = popCell(visits);
+        length = std::max(length, board.getDistance(position, cell) + board.getDistance(cell, target));
+    }
+    return length;
+}
+
+int getMaximumPathLength(BoardState const& state, int shapeIndex)
+{
+    // a new edge takes one valence from both of its nodes.
+    auto valence = state.getRemainingValenceSum(shapeIndex) + state.getRemainingRestrictedValence();
+    return state.getPendingCount(shapeIndex) + valence / 2;
+}
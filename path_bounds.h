@@ -0,0 +1,26 @@
+#ifndef PATH_BOUNDS_H_INCLUDED
+#define PATH_BOUNDS_H_INCLUDED
+
+#include "board_state.h"
+
+/**
+ *  Length bounds for the rest of a path. The nodes of a shape are visited exactly once,
+ *  but how often the path passes valence restricted nodes is open, so the remaining length
+ *  is only known within bounds:
+ *   - at least one move per node still to visit and per pending edge to walk, and at least
+ *     the king distance from the position over any of those nodes to the target.
+ *   - at most the pending edges plus half the valence left on nodes the shape can use.
+ */
+
+// fewest moves a path continuing at position needs to finish the shape.
+int getMinimumPathLength(BoardState const& state, int shapeIndex, CellIndex position, CellIndex target);
+
+// most moves the remaining connections allow the shape.
+int getMaximumPathLength(BoardState const& state, int shapeIndex);
+
+inline bool isWithinPathBounds(BoardState const& state, int shapeIndex, CellIndex position, CellIndex target)
+{
+    return getMinimumPathLength(state, shapeIndex, position, target) <= getMaximumPathLength(state, shapeIndex);
+}
+
+#endif // PATH_BOUNDS_H_INCLUDED
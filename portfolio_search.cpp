@@ -0,0 +1,97 @@
+#include "portfolio_search.h"
+
+#include <cstdint>
+#include <sstream>
+
+namespace
+{
+    struct Variant
+    {
+        MoveOrdering ordering;
+        ShapeOrdering shapeOrdering;
+        bool bidirectional;
+    };
+
+    // deterministic configurations that behave differently from the default one
+    Variant const variants[] = {
+        {MoveOrdering::FewestOptions, ShapeOrdering::MostConstrained, false},
+        {MoveOrdering::DeadEndFirst, ShapeOrdering::Interleaved, false},
+        {MoveOrdering::TowardsTarget, ShapeOrdering::MostConstrained, true},
+        {MoveOrdering::DeadEndFirst, ShapeOrdering::MostConstrained, true}
+    };
+
+    char const* getName(MoveOrdering ordering)
+    {
+        switch (ordering)
+        {
+        case MoveOrdering::Fixed: return "fixed";
+        case MoveOrdering::FewestOptions: return "fewest options";
+        case MoveOrdering::DeadEndFirst: return "dead end first";
+        case MoveOrdering::TowardsTarget: return "towards target";
+        case MoveOrdering::Random: return "random";
+        }
+        return "";
+    }
+
+    char const* getName(ShapeOrdering ordering)
+    {
+        switch (ordering)
+        {
+        case ShapeOrdering::Sequential: return "sequential";
+        case ShapeOrdering::MostConstrained: return "most constrained";
+        case ShapeOrdering::Interleaved: return "interleaved";
+        }
+        return "";
+    }
+}
+
+std::vector <PortfolioMember> makePortfolio(SolveOptions const& options)
+{
+    auto base = options;
+    base.threads = 1;
+    base.portfolio = 0;
+
+    // every other member is a restarting random walk, the rest cycle through the variants.
+    std::vector <PortfolioMember> members{{base, base.ordering == MoveOrdering::Random}};
+    for (unsigned i = 1; i < options.portfolio; ++i)
+    {
+        auto member = base;
+        auto round = (i - 1) / 2;
+        if ((i - 1) % 2 == 0)
+        {
+            member.ordering = MoveOrdering::Random;
+            if (round % 2 == 1)
+                member.shapeOrdering = ShapeOrdering::Interleaved;
+        }
+        else
+        {
+            auto const& variant = variants[round % (sizeof(variants) / sizeof(variants[0]))];
+            member.ordering = variant.ordering;
+            member.shapeOrdering = variant.shapeOrdering;
+            member.bidirectional = variant.bidirectional;
+        }
+        members.push_back({member, member.ordering == MoveOrdering::Random});
+    }
+    return members;
+}
+
+unsigned getRestartSeed(unsigned seed, int member, int restart)
+{
+    // splitmix64 of the three
+    auto key = (static_cast <std::uint64_t> (seed) << 32) ^ (static_cast <std::uint64_t> (member) << 16) ^ static_cast <std::uint64_t> (restart);
+    key += 0x9e3779b97f4a7c15ull;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return static_cast <unsigned> (key ^ (key >> 31));
+}
+
+std::string describePortfolioMember(int member, SolveOptions const& options, int restart)
+{
+    std::ostringstream description;
+    description << "member " << member << ": " << getName(options.ordering) << " moves, " << getName(options.shapeOrdering) << " shapes";
+    if (options.bidirectional)
+        description << ", bidirectional";
+    if (options.ordering == MoveOrdering::Random)
+        description << ", seed " << options.seed << " after " << restart << " restarts";
+    return description.str();
+}
@@ -0,0 +1,113 @@
+#ifndef PORTFOLIO_SEARCH_H_INCLUDED
+#define PORTFOLIO_SEARCH_H_INCLUDED
+
+#include "cursor_search.h"
+#include "restart_schedule.h"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PortfolioMember
+{
+    SolveOptions options;
+    bool restarts; // a new seed after every Luby budget, only for random move orderings
+};
+
+// the first member searches with the given options, the others vary ordering, seed and fronts
+std::vector <PortfolioMember> makePortfolio(SolveOptions const& options);
+
+// reproducible from the seed of the solve alone
+unsigned getRestartSeed(unsigned seed, int member, int restart);
+
+std::string describePortfolioMember(int member, SolveOptions const& options, int restart);
+
+/**
+ *  Races the members of a portfolio on the same board, one thread each. Solve times are
+ *  heavy tailed, so one of several differently ordered searches usually finishes long before
+ *  the typical one. The first member that solves the board or proves it unsolvable stops the others.
+ */
+template <typename Geometry>
+std::vector <NodePath> runPortfolioSearch(NodeMatrix const& board, Geometry geometry, SolveOptions const& options, HamiltonianOracle const* oracle,
+                                          SolveBudget* budget, long long& stepCounter, long long& backtrackCounter, SolveStatistics& statistics)
+{
+    using Search = CursorSearch <Geometry>;
+
+    auto members = makePortfolio(options);
+    std::atomic <bool> done(false);
+    std::mutex resultMutex;
+    std::vector <NodePath> result;
+    bool solved = false;
+    std::string winner;
+    std::vector <WorkerCounters> counters(members.size());
+
+    auto race = [&](int member)
+    {
+        auto& counter = counters[member];
+        for (int restart = 0; !done.load(std::memory_order_relaxed) && (budget == nullptr || !budget->isExhausted()); ++restart)
+        {
+            auto memberOptions = members[member].options;
+            if (members[member].restarts)
+                memberOptions.seed = getRestartSeed(options.seed, member, restart);
+
+            // a search that ran to its end decides the board either way, so does an invalid board.
+            // The search is made in here, its exceptions must not leave the thread.
+            std::vector <NodePath> pathes;
+            bool found = true;
+            try
+            {
+                Search search(board, geometry, memberOptions, counter.stepCounter, counter.backtrackCounter, counter.statistics, oracle);
+                search.setCancelFlag(&done);
+                search.setBudget(budget);
+                if (members[member].restarts)
+                    search.setStepLimit(getLubyTerm(restart) * options.restartSteps);
+
+                pathes = search.run();
+                if (search.isCancelled())
+                    continue;
+            }
+            catch (std::runtime_error const&)
+            {
+                found = false;
+            }
+
+            std::lock_guard <std::mutex> lock(resultMutex);
+            if (!done.exchange(true))
+            {
+                result = pathes;
+                solved = found;
+                winner = describePortfolioMember(member, memberOptions, restart);
+            }
+            return;
+        }
+    };
+
+    std::vector <std::thread> threads;
+    for (int i = 1; i < static_cast <int> (members.size()); ++i)
+        threads.emplace_back(race, i);
+    race(0);
+    for (auto& i : threads)
+        i.join();
+
+    for (auto const& i : counters)
+    {
+        stepCounter += i.stepCounter;
+        backtrackCounter += i.backtrackCounter;
+        statistics.add(i.statistics);
+    }
+    statistics.portfolioWinner = winner;
+
+    // without a winner the budget stopped every member
+    if (!solved)
+    {
+        if (winner.empty() && budget != nullptr)
+            budget->interrupt();
+        throw std::runtime_error("No solution");
+    }
+    return result;
+}
+
+#endif // PORTFOLIO_SEARCH_H_INCLUDED
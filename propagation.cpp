@@ -0,0 +1,78 @@
+#include "propagation.h"
+
+namespace
+{
+    inline bool isConnectable(BoardState const& state, CellIndex cell, Neighbour const& neighbour)
+    {
+        auto const& board = state.getBoard();
+
+        if (state.isConnected(neighbour.edge) || state.getRemainingValence(neighbour.cell) == 0)
+            return false;
+
+        auto crossing = board.getCrossingEdge(neighbour.edge);
+        if (crossing != -1 && state.isConnected(crossing))
+            return false;
+
+        auto shape1 = board.getShape(cell);
+        auto shape2 = board.getShape(neighbour.cell);
+        return shape1 == shape2 || shape1 == NodeShape::ValenceRestricted || shape2 == NodeShape::ValenceRestricted;
+    }
+
+    // the index of the shape an edge between both cells must have, -1 if both are valence restricted.
+    inline int getEdgeShapeIndex(NodeMatrix const& board, CellIndex cell1, CellIndex cell2)
+    {
+        if (board.getShapeIndex(cell1) != -1)
+            return board.getShapeIndex(cell1);
+        return board.getShapeIndex(cell2);
+    }
+}
+
+CellMask getAffectedCells(NodeMatrix const& board, EdgeIndex edge)
+{
+    // the crossing diagonal connects two common neighbours, so its ends are included.
+    auto cells = board.getEdgeCells(edge);
+    return cellBit(cells.first) | cellBit(cells.second) |
+           board.getNeighbourCells(cells.first) | board.getNeighbourCells(cells.second);
+}
+
+bool propagate(BoardState& state, CellMask cells, CellMask* visited)
+{
+    auto const& board = state.getBoard();
+
+    while (cells)
+    {
+        auto cell = popCell(cells);
+        if (visited)
+            *visited |= cellBit(cell);
+
+        auto remaining = state.getRemainingValence(cell);
+        if (remaining == 0)
+            continue;
+
+        Neighbour connectable[DirectionCount];
+        int count = 0;
+        for (auto const& neighbour : board.getNeighbours(cell))
+            if (isConnectable(state, cell, neighbour))
+                connectable[count++] = neighbour;
+
+        if (remaining > count)
+            return false;
+        if (remaining < count)
+            continue;
+
+        for (int i = 0; i != count; ++i)
+        {
+            auto shapeIndex = getEdgeShapeIndex(board, cell, connectable[i].cell);
+            if (shapeIndex == -1)
+                continue;
+
+            // an edge forced just before may have taken this one away.
+            if (!isConnectable(state, cell, connectable[i]))
+                return false;
+
+            state.force(connectable[i].edge, shapeIndex);
+            cells |= getAffectedCells(board, connectable[i].edge);
+        }
+    }
+    return true;
+}
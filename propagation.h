@@ -0,0 +1,22 @@
+#ifndef PROPAGATION_H_INCLUDED
+#define PROPAGATION_H_INCLUDED
+
+#include "board_state.h"
+
+/**
+ *  Applies the connection rules to every cell in the given mask and to every cell affected by
+ *  a deduction, until nothing changes:
+ *   - a node that needs more connections than it has connectable neighbours is a dead end.
+ *   - a node that needs exactly as many connections as it has connectable neighbours
+ *     gets all of them as pending edges, if the shape of the edge is known.
+ *
+ *  Returns false if the board can no longer be solved. The deductions stay on the trail
+ *  either way, rewind to a mark taken before to get rid of them.
+ *  If visited is given, it receives every cell that was looked at.
+ */
+bool propagate(BoardState& state, CellMask cells, CellMask* visited = nullptr);
+
+// cells whose connectable neighbours change when the edge gets connected.
+CellMask getAffectedCells(NodeMatrix const& board, EdgeIndex edge);
+
+#endif // PROPAGATION_H_INCLUDED
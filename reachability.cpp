@@ -0,0 +1,34 @@
+#include "reachability.h"
+
+CellMask getReachableCells(NodeMatrix const& board, CellMask from, CellMask passable)
+{
+    auto reached = from;
+    for (;;)
+    {
+        auto next = reached | (board.growCells(reached) & passable);
+        if (next == reached)
+            return reached;
+        reached = next;
+    }
+}
+
+bool canReachShape(BoardState const& state, int shapeIndex, CellIndex position, CellIndex target, CellMask* blocking)
+{
+    auto const& board = state.getBoard();
+
+    auto usable = state.getOpenCells() | state.getPendingCells();
+    auto required = board.getShapeCells(shapeIndex) & usable & ~cellBit(position);
+
+    // the path ends at the target. Only a valence restricted target, the head of a path
+    // growing from the other end, can be passed on the way.
+    auto passable = (board.getShapeCells(shapeIndex) | board.getValenceRestrictedCells()) & usable;
+    passable &= ~(cellBit(target) & ~board.getValenceRestrictedCells());
+
+    auto reached = getReachableCells(board, cellBit(position), passable);
+    reached |= board.growCells(reached) & cellBit(target);
+
+    auto missed = required & ~reached;
+    if (missed != 0 && blocking)
+        *blocking = board.growCells(reached) | missed;
+    return missed == 0;
+}
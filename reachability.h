@@ -0,0 +1,19 @@
+#ifndef REACHABILITY_H_INCLUDED
+#define REACHABILITY_H_INCLUDED
+
+#include "board_state.h"
+
+/**
+ *  Flood fill over cell masks, one step adds the whole neighbourhood of the filled area.
+ *  Crossings and used edges are ignored, so a cell reported unreachable is unreachable for sure.
+ */
+
+// every cell of passable that can be reached from the given cells through passable cells.
+CellMask getReachableCells(NodeMatrix const& board, CellMask from, CellMask passable);
+
+// can a path of the shape continuing at position still visit every node of the shape that misses connections
+// or has pending edges, and end at target? The target is a node of the shape or the head of its other front.
+// If it can not, blocking receives the cells that decide it: the filled area, its border and the missed nodes.
+bool canReachShape(BoardState const& state, int shapeIndex, CellIndex position, CellIndex target, CellMask* blocking = nullptr);
+
+#endif // REACHABILITY_H_INCLUDED
@@ -0,0 +1,24 @@
+#ifndef RESTART_SCHEDULE_H_INCLUDED
+#define RESTART_SCHEDULE_H_INCLUDED
+
+// the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ..., index counts from 0.
+// Restarting after budget * getLubyTerm(i) is within a log factor of the best fixed budget.
+inline long long getLubyTerm(int index)
+{
+    int size = 1;
+    int sequence = 0;
+    while (size < index + 1)
+    {
+        ++sequence;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != index)
+    {
+        size = (size - 1) >> 1;
+        --sequence;
+        index = index % size;
+    }
+    return 1ll << sequence;
+}
+
+#endif // RESTART_SCHEDULE_H_INCLUDED
@@ -0,0 +1,384 @@
+#include "sat_solver.h"
+#include "restart_schedule.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr long long restartInterval = 100; // conflicts per unit of the Luby sequence
+    constexpr double activityDecay = 0.95;
+}
+
+SatSolver::SatSolver ()
+    : clauses_()
+    , watches_()
+    , values_()
+    , phases_()
+    , levels_()
+    , reasons_()
+    , trail_()
+    , levelStarts_()
+    , propagated_(0)
+    , activities_()
+    , activityIncrement_(1.0)
+    , heap_()
+    , heapPositions_()
+    , seen_()
+    , unsatisfiable_(false)
+    , stop_()
+    , interrupted_(false)
+    , decisions_(0)
+    , conflicts_(0)
+{
+}
+
+int SatSolver::addVariable()
+{
+    auto variable = getVariableCount();
+    watches_.resize(watches_.size() + 2);
+    values_.push_back(-1);
+    phases_.push_back(0);
+    levels_.push_back(0);
+    reasons_.push_back(-1);
+    activities_.push_back(0.0);
+    heapPositions_.push_back(-1);
+    seen_.push_back(0);
+    heapInsert(variable);
+    return variable;
+}
+
+int SatSolver::getVariableCount() const
+{
+    return static_cast <int> (values_.size());
+}
+
+bool SatSolver::addClause(std::vector <Literal> clause)
+{
+    backtrackTo(0);
+    if (unsatisfiable_)
+        return false;
+
+    // drop duplicates and literals false for good, satisfied clauses and tautologies are not needed.
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+    std::vector <Literal> literals;
+    for (std::size_t i = 0; i != clause.size(); ++i)
+    {
+        if (i + 1 != clause.size() && clause[i + 1] == negateLiteral(clause[i]))
+            return true;
+        auto value = getLiteralValue(clause[i]);
+        if (value == 1)
+            return true;
+        if (value == -1)
+            literals.push_back(clause[i]);
+    }
+
+    if (literals.empty())
+    {
+        unsatisfiable_ = true;
+        return false;
+    }
+    if (literals.size() == 1)
+    {
+        assign(literals[0], -1);
+        if (propagate() != -1)
+            unsatisfiable_ = true;
+        return !unsatisfiable_;
+    }
+
+    attachClause(std::move(literals));
+    return true;
+}
+
+int SatSolver::attachClause(std::vector <Literal> literals)
+{
+    auto index = static_cast <int> (clauses_.size());
+    watches_[literals[0]].push_back(index);
+    watches_[literals[1]].push_back(index);
+    clauses_.push_back(Clause{std::move(literals)});
+    return index;
+}
+
+void SatSolver::assign(Literal literal, int reason)
+{
+    auto variable = getVariable(literal);
+    values_[variable] = static_cast <std::int8_t> ((literal & 1) ^ 1);
+    levels_[variable] = getLevel();
+    reasons_[variable] = reason;
+    trail_.push_back(literal);
+}
+
+int SatSolver::propagate()
+{
+    while (propagated_ != trail_.size())
+    {
+        auto falseLiteral = negateLiteral(trail_[propagated_++]);
+        auto& watches = watches_[falseLiteral];
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i != watches.size(); ++i)
+        {
+            auto index = watches[i];
+            auto& literals = clauses_[index].literals;
+            if (literals[0] == falseLiteral)
+                std::swap(literals[0], literals[1]);
+            if (getLiteralValue(literals[0]) == 1)
+            {
+                watches[kept++] = index;
+                continue;
+            }
+
+            // look for another literal to watch
+            bool moved = false;
+            for (std::size_t k = 2; k != literals.size(); ++k)
+            {
+                if (getLiteralValue(literals[k]) != 0)
+                {
+                    std::swap(literals[1], literals[k]);
+                    watches_[literals[1]].push_back(index);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved)
+                continue;
+
+            watches[kept++] = index;
+            if (getLiteralValue(literals[0]) == 0)
+            {
+                for (++i; i != watches.size(); ++i)
+                    watches[kept++] = watches[i];
+                watches.resize(kept);
+                return index;
+            }
+            assign(literals[0], index);
+        }
+        watches.resize(kept);
+    }
+    return -1;
+}
+
+int SatSolver::analyze(int conflict, std::vector <Literal>& learnt)
+{
+    // resolve the conflict with the reasons of the current level until one literal of it is left.
+    learnt.assign(1, 0);
+    int open = 0;
+    Literal resolved = -1;
+    auto position = trail_.size();
+    do
+    {
+        auto const& literals = clauses_[conflict].literals;
+        for (std::size_t i = resolved == -1 ? 0 : 1; i != literals.size(); ++i)
+        {
+            auto variable = getVariable(literals[i]);
+            if (seen_[variable] || levels_[variable] == 0)
+                continue;
+
+            seen_[variable] = 1;
+            bumpVariable(variable);
+            if (levels_[variable] == getLevel())
+                ++open;
+            else
+                learnt.push_back(literals[i]);
+        }
+
+        while (!seen_[getVariable(trail_[--position])])
+            ;
+        resolved = trail_[position];
+        conflict = reasons_[getVariable(resolved)];
+        seen_[getVariable(resolved)] = 0;
+        --open;
+    }
+    while (open > 0);
+    learnt[0] = negateLiteral(resolved);
+
+    // the second watch goes to the literal of the highest level left
+    int level = 0;
+    for (std::size_t i = 1; i != learnt.size(); ++i)
+    {
+        seen_[getVariable(learnt[i])] = 0;
+        if (levels_[getVariable(learnt[i])] > level)
+        {
+            level = levels_[getVariable(learnt[i])];
+            std::swap(learnt[1], learnt[i]);
+        }
+    }
+    return level;
+}
+
+void SatSolver::backtrackTo(int level)
+{
+    if (getLevel() <= level)
+        return;
+
+    for (auto i = trail_.size(); i != static_cast <std::size_t> (levelStarts_[level]); --i)
+    {
+        auto variable = getVariable(trail_[i - 1]);
+        phases_[variable] = values_[variable];
+        values_[variable] = -1;
+        heapInsert(variable);
+    }
+    trail_.resize(levelStarts_[level]);
+    levelStarts_.resize(level);
+    propagated_ = trail_.size();
+}
+
+int SatSolver::pickVariable()
+{
+    while (!heap_.empty())
+    {
+        auto variable = heapPop();
+        if (values_[variable] == -1)
+            return variable;
+    }
+    return -1;
+}
+
+bool SatSolver::solve()
+{
+    interrupted_ = false;
+    backtrackTo(0);
+    if (unsatisfiable_ || propagate() != -1)
+    {
+        unsatisfiable_ = true;
+        return false;
+    }
+
+    int restarts = 0;
+    auto conflictsLeft = getLubyTerm(restarts) * restartInterval;
+    std::vector <Literal> learnt;
+    for (;;)
+    {
+        if (stop_ && stop_())
+        {
+            interrupted_ = true;
+            return false;
+        }
+
+        auto conflict = propagate();
+        if (conflict != -1)
+        {
+            ++conflicts_;
+            if (getLevel() == 0)
+            {
+                unsatisfiable_ = true;
+                return false;
+            }
+
+            backtrackTo(analyze(conflict, learnt));
+            if (learnt.size() == 1)
+                assign(learnt[0], -1);
+            else
+                assign(learnt[0], attachClause(learnt));
+            activityIncrement_ /= activityDecay;
+
+            if (--conflictsLeft == 0)
+            {
+                conflictsLeft = getLubyTerm(++restarts) * restartInterval;
+                backtrackTo(0);
+            }
+            continue;
+        }
+
+        auto variable = pickVariable();
+        if (variable == -1)
+            return true;
+
+        ++decisions_;
+        levelStarts_.push_back(static_cast <int> (trail_.size()));
+        assign(makeLiteral(variable, phases_[variable] != 1), -1);
+    }
+}
+
+bool SatSolver::getValue(int variable) const
+{
+    return values_[variable] == 1;
+}
+
+void SatSolver::setStopCondition(std::function <bool ()> const& stop)
+{
+    stop_ = stop;
+}
+
+bool SatSolver::isInterrupted() const
+{
+    return interrupted_;
+}
+
+long long SatSolver::getDecisions() const
+{
+    return decisions_;
+}
+
+long long SatSolver::getConflicts() const
+{
+    return conflicts_;
+}
+
+void SatSolver::bumpVariable(int variable)
+{
+    activities_[variable] += activityIncrement_;
+    if (activities_[variable] > 1e100)
+    {
+        for (auto& i : activities_)
+            i *= 1e-100;
+        activityIncrement_ *= 1e-100;
+    }
+    if (heapPositions_[variable] != -1)
+        heapUp(heapPositions_[variable]);
+}
+
+void SatSolver::heapInsert(int variable)
+{
+    if (heapPositions_[variable] != -1)
+        return;
+    heapPositions_[variable] = static_cast <int> (heap_.size());
+    heap_.push_back(variable);
+    heapUp(heapPositions_[variable]);
+}
+
+int SatSolver::heapPop()
+{
+    auto top = heap_[0];
+    heap_[0] = heap_.back();
+    heapPositions_[heap_[0]] = 0;
+    heap_.pop_back();
+    heapPositions_[top] = -1;
+    if (!heap_.empty())
+        heapDown(0);
+    return top;
+}
+
+void SatSolver::heapUp(int position)
+{
+    auto variable = heap_[position];
+    while (position > 0 && activities_[heap_[(position - 1) / 2]] < activities_[variable])
+    {
+        heap_[position] = heap_[(position - 1) / 2];
+        heapPositions_[heap_[position]] = position;
+        position = (position - 1) / 2;
+    }
+    heap_[position] = variable;
+    heapPositions_[variable] = position;
+}
+
+void SatSolver::heapDown(int position)
+{
+    auto variable = heap_[position];
+    auto size = static_cast <int> (heap_.size());
+    for (;;)
+    {
+        auto child = 2 * position + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && activities_[heap_[child + 1]] > activities_[heap_[child]])
+            ++child;
+        if (activities_[heap_[child]] <= activities_[variable])
+            break;
+        heap_[position] = heap_[child];
+        heapPositions_[heap_[position]] = position;
+        position = child;
+    }
+    heap_[position] = variable;
+    heapPositions_[variable] = position;
+}
@@ -0,0 +1,111 @@
+#ifndef SAT_SOLVER_H_INCLUDED
+#define SAT_SOLVER_H_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// variable * 2, +1 if negated
+using Literal = int;
+
+inline Literal makeLiteral(int variable, bool negated = false)
+{
+    return 2 * variable + (negated ? 1 : 0);
+}
+
+inline Literal negateLiteral(Literal literal)
+{
+    return literal ^ 1;
+}
+
+inline int getVariable(Literal literal)
+{
+    return literal >> 1;
+}
+
+/**
+ *  A small CDCL SAT solver: two watched literals per clause, first UIP learning,
+ *  VSIDS decisions with saved phases and restarts following the Luby sequence.
+ *
+ *  Clauses can be added between two calls of solve(), the learned clauses stay valid.
+ */
+class SatSolver
+{
+public:
+    SatSolver ();
+
+    int addVariable();
+    int getVariableCount() const;
+
+    // false if the problem became unsatisfiable
+    bool addClause(std::vector <Literal> clause);
+
+    // true if satisfiable, getValue() then tells the model
+    bool solve();
+    bool getValue(int variable) const;
+
+    // asked before every decision and after every conflict, solve() returns false once it says so
+    void setStopCondition(std::function <bool ()> const& stop);
+    bool isInterrupted() const;
+
+    long long getDecisions() const;
+    long long getConflicts() const;
+
+private:
+    struct Clause
+    {
+        std::vector <Literal> literals; // literals[0] and [1] are watched
+    };
+
+    // 1 if true, 0 if false, -1 if unassigned
+    inline int getLiteralValue(Literal literal) const
+    {
+        auto value = values_[getVariable(literal)];
+        return value == -1 ? -1 : value ^ (literal & 1);
+    }
+
+    inline int getLevel() const
+    {
+        return static_cast <int> (levelStarts_.size());
+    }
+
+    int attachClause(std::vector <Literal> literals);
+    void assign(Literal literal, int reason);
+    int propagate();
+    int analyze(int conflict, std::vector <Literal>& learnt);
+    void backtrackTo(int level);
+    int pickVariable();
+
+    // VSIDS
+    void bumpVariable(int variable);
+    void heapInsert(int variable);
+    int heapPop();
+    void heapUp(int position);
+    void heapDown(int position);
+
+private:
+    std::vector <Clause> clauses_;
+    std::vector <std::vector <int> > watches_; // per literal, clauses watching it
+
+    std::vector <std::int8_t> values_; // per variable
+    std::vector <std::int8_t> phases_; // last value of each variable
+    std::vector <int> levels_;
+    std::vector <int> reasons_; // clause that implied the variable, -1 for decisions
+    std::vector <Literal> trail_;
+    std::vector <int> levelStarts_; // trail size when each level was entered
+    std::size_t propagated_;
+
+    std::vector <double> activities_;
+    double activityIncrement_;
+    std::vector <int> heap_;
+    std::vector <int> heapPositions_; // -1 if not in the heap
+    std::vector <char> seen_;
+
+    bool unsatisfiable_;
+    std::function <bool ()> stop_;
+    bool interrupted_;
+    long long decisions_;
+    long long conflicts_;
+};
+
+#endif // SAT_SOLVER_H_INCLUDED
@@ -0,0 +1,115 @@
+#ifndef SOLUTION_ENUMERATION_H_INCLUDED
+#define SOLUTION_ENUMERATION_H_INCLUDED
+
+#include "parallel_search.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+/**
+ *  Runs the cursor search past every solution it finds. Walking a valence restricted node
+ *  in a different order gives the same lines, so solutions are told apart by their edges.
+ *  onSolution gets every distinct one, one at a time, and can stop the search by returning
+ *  false. So does reaching the limit, 0 for none. Throws SolveInterrupted if the budget runs
+ *  out first, the solutions found until then went to onSolution.
+ *
+ *  With several threads the tree is cut into subtrees like for runParallelSearch.
+ */
+template <typename Geometry>
+std::size_t runEnumeration(NodeMatrix const& board, Geometry geometry, SolveOptions const& options, HamiltonianOracle const* oracle,
+                           SolveBudget* budget, long long& stepCounter, long long& backtrackCounter, SolveStatistics& statistics,
+                           std::function <bool (std::vector <NodePath> const&)> const& onSolution, std::size_t limit)
+{
+    using Search = CursorSearch <Geometry>;
+    using Prefix = typename Search::Prefix;
+
+    std::mutex mutex;
+    std::unordered_set <std::uint64_t> seen;
+    std::size_t count = 0;
+    std::atomic <bool> stop(false);
+
+    typename Search::SolutionCallback report = [&](std::vector <NodePath> const& pathes, std::uint64_t hash)
+    {
+        std::lock_guard <std::mutex> lock(mutex);
+        if (stop.load(std::memory_order_relaxed))
+            return false;
+        if (!seen.insert(hash).second)
+            return true;
+
+        ++count;
+        if ((onSolution && !onSolution(pathes)) || (limit != 0 && count >= limit))
+            stop = true;
+        return !stop.load(std::memory_order_relaxed);
+    };
+
+    // the search ends by running out of nodes
+    auto threads = getThreadCount(options);
+    if (threads == 1)
+    {
+        Search search(board, geometry, options, stepCounter, backtrackCounter, statistics, oracle);
+        search.setSolutionCallback(report);
+        search.setBudget(budget);
+        try
+        {
+            search.run();
+        }
+        catch (std::runtime_error const&)
+        {
+        }
+
+        if (search.isCancelled())
+            budget->interrupt();
+        return count;
+    }
+
+    std::vector <Prefix> prefixes;
+    std::vector <NodePath> pathes;
+    if (splitSearch(board, geometry, options, oracle, budget, stepCounter, backtrackCounter, statistics, report, prefixes, pathes))
+        return count;
+
+    std::vector <WorkerCounters> counters(threads);
+    std::vector <WorkStealingPool::Task> tasks;
+    for (auto const& prefix : prefixes)
+    {
+        tasks.push_back([&, prefix](unsigned worker)
+        {
+            if (stop.load(std::memory_order_relaxed))
+                return;
+
+            auto& counter = counters[worker];
+            Search search(board, geometry, options, counter.stepCounter, counter.backtrackCounter, counter.statistics, oracle);
+            search.setPrefix(prefix);
+            search.setCancelFlag(&stop);
+            search.setSolutionCallback(report);
+            search.setBudget(budget);
+            try
+            {
+                search.run();
+            }
+            catch (std::runtime_error const&)
+            {
+            }
+        });
+    }
+
+    WorkStealingPool pool(threads);
+    pool.run(std::move(tasks));
+
+    for (auto const& i : counters)
+    {
+        stepCounter += i.stepCounter;
+        backtrackCounter += i.backtrackCounter;
+        statistics.add(i.statistics);
+    }
+
+    // stopped by the budget rather than by onSolution or the limit
+    if (!stop && budget != nullptr && budget->isExhausted())
+        budget->interrupt();
+    return count;
+}
+
+#endif // SOLUTION_ENUMERATION_H_INCLUDED
@@ -0,0 +1,145 @@
+#include "solve_budget.h"
+
+namespace
+{
+    char const* describeStatus(SolveStatus status)
+    {
+        switch (status)
+        {
+        case SolveStatus::TimedOut:
+            return "Timed out";
+        case SolveStatus::OutOfSteps:
+            return "Out of steps";
+        case SolveStatus::Cancelled:
+            return "Cancelled";
+        default:
+            return "Interrupted";
+        }
+    }
+}
+
+SolveInterrupted::SolveInterrupted (SolveStatus status, std::vector <NodePath> partial)
+    : std::runtime_error(describeStatus(status))
+    , status_(status)
+    , partial_(std::move(partial))
+{
+}
+
+SolveStatus SolveInterrupted::getStatus() const
+{
+    return status_;
+}
+
+std::vector <NodePath> const& SolveInterrupted::getPartial() const
+{
+    return partial_;
+}
+
+constexpr long long SolveBudget::chargeInterval;
+
+SolveBudget::SolveBudget (SolveOptions const& options)
+    : parent_(nullptr)
+    , cancel_(options.cancellation.getFlag())
+    , hasDeadline_(options.timeBudgetMs > 0)
+    , start_(std::chrono::steady_clock::now())
+    , deadline_(start_ + std::chrono::milliseconds(options.timeBudgetMs))
+    , maxSteps_(options.maxSteps)
+    , spent_(0)
+    , exhausted_(false)
+    , status_(SolveStatus::Solved)
+    , partialMutex_()
+    , partialDepth_(0)
+    , partial_()
+{
+}
+
+SolveBudget::SolveBudget (SolveBudget* parent, std::atomic <bool> const* cancel)
+    : parent_(parent)
+    , cancel_(cancel)
+    , hasDeadline_(false)
+    , start_()
+    , deadline_()
+    , maxSteps_(0)
+    , spent_(0)
+    , exhausted_(false)
+    , status_(SolveStatus::Solved)
+    , partialMutex_()
+    , partialDepth_(0)
+    , partial_()
+{
+}
+
+void SolveBudget::charge(long long steps)
+{
+    if (parent_ != nullptr)
+    {
+        parent_->charge(steps);
+        return;
+    }
+
+    spent_.fetch_add(steps, std::memory_order_relaxed);
+    if (!exhausted_.load(std::memory_order_relaxed))
+        checkLimits(0);
+}
+
+bool SolveBudget::checkLimits(long long uncharged)
+{
+    if (cancel_ != nullptr && cancel_->load(std::memory_order_relaxed))
+        exhaust(SolveStatus::Cancelled);
+    else if (maxSteps_ > 0 && spent_.load(std::memory_order_relaxed) + uncharged >= maxSteps_)
+        exhaust(SolveStatus::OutOfSteps);
+    else if (hasDeadline_ && std::chrono::steady_clock::now() >= deadline_)
+        exhaust(SolveStatus::TimedOut);
+    else
+        return false;
+    return true;
+}
+
+bool SolveBudget::isExhausted() const
+{
+    if (parent_ != nullptr)
+        return (cancel_ != nullptr && cancel_->load(std::memory_order_relaxed)) || parent_->isExhausted();
+    return exhausted_.load(std::memory_order_relaxed);
+}
+
+bool SolveBudget::isPastShare(double share) const
+{
+    if (parent_ != nullptr)
+        return (cancel_ != nullptr && cancel_->load(std::memory_order_relaxed)) || parent_->isPastShare(share);
+    if (exhausted_.load(std::memory_order_relaxed) || (cancel_ != nullptr && cancel_->load(std::memory_order_relaxed)))
+        return true;
+    return hasDeadline_ && std::chrono::steady_clock::now() >= start_ + std::chrono::duration_cast <std::chrono::steady_clock::duration> ((deadline_ - start_) * share);
+}
+
+SolveStatus SolveBudget::getStatus() const
+{
+    if (parent_ != nullptr && cancel_ != nullptr && cancel_->load() && !parent_->isExhausted())
+        return SolveStatus::Cancelled;
+    if (parent_ != nullptr)
+        return parent_->getStatus();
+    return status_.load();
+}
+
+void SolveBudget::offerPartial(std::vector <NodePath> const& pathes, std::size_t depth)
+{
+    std::lock_guard <std::mutex> lock(partialMutex_);
+    if (partial_.empty() || depth > partialDepth_)
+    {
+        partial_ = pathes;
+        partialDepth_ = depth;
+    }
+}
+
+void SolveBudget::interrupt()
+{
+    std::lock_guard <std::mutex> lock(partialMutex_);
+    throw SolveInterrupted(getStatus(), partial_);
+}
+
+void SolveBudget::exhaust(SolveStatus status)
+{
+    // the first reason sticks
+    auto expected = SolveStatus::Solved;
+    status_.compare_exchange_strong(expected, status);
+    exhausted_.store(true);
+}
@@ -0,0 +1,127 @@
+#ifndef SOLVE_BUDGET_H_INCLUDED
+#define SOLVE_BUDGET_H_INCLUDED
+
+#include "path.h"
+#include "solve_options.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+enum class SolveStatus
+{
+    Solved,
+    NoSolution,
+    TimedOut, // SolveOptions::timeBudgetMs ran out
+    OutOfSteps, // SolveOptions::maxSteps ran out
+    Cancelled // by SolveOptions::cancellation
+};
+
+// what LYNESolver::trySolve found: the solution, or the deepest partial state when it had to stop
+struct SolveResult
+{
+    SolveStatus status = SolveStatus::NoSolution;
+    std::vector <NodePath> pathes; // same order and direction as a solution, partial paths may be shorter
+};
+
+// thrown by a solve that ran out of its budget
+class SolveInterrupted : public std::runtime_error
+{
+public:
+    SolveInterrupted (SolveStatus status, std::vector <NodePath> partial);
+
+    SolveStatus getStatus() const;
+
+    // the deepest state the search reached, empty if the engine can't tell
+    std::vector <NodePath> const& getPartial() const;
+
+private:
+    SolveStatus status_;
+    std::vector <NodePath> partial_;
+};
+
+/**
+ *  The limits of one solve, shared by all of its searches. Checking it is cheap enough for
+ *  every step: the cancellation token and the steps spent are relaxed loads. The searches
+ *  charge their steps every chargeInterval of them, which also reads the clock. Once one
+ *  search finds it exhausted, so do all the others.
+ *
+ *  The searches hand in the deepest state they reached, counted in steps, when they stop.
+ */
+class SolveBudget
+{
+public:
+    static constexpr long long chargeInterval = 128;
+
+    // the time budget starts now
+    explicit SolveBudget (SolveOptions const& options);
+
+    // exhausted with its parent or once cancel is set, but collects a partial state of its own,
+    // e.g. for a group of shapes
+    explicit SolveBudget (SolveBudget* parent, std::atomic <bool> const* cancel = nullptr);
+
+    // uncharged is how many steps the calling search made since it last charged them
+    inline bool isExhausted(long long uncharged)
+    {
+        if (parent_ != nullptr)
+            return (cancel_ != nullptr && cancel_->load(std::memory_order_relaxed)) || parent_->isExhausted(uncharged);
+        if (exhausted_.load(std::memory_order_relaxed))
+            return true;
+
+        // everything but the relaxed loads is out of line
+        return ((cancel_ != nullptr && cancel_->load(std::memory_order_relaxed))
+                || (maxSteps_ > 0 && spent_.load(std::memory_order_relaxed) + uncharged >= maxSteps_)) && checkLimits(uncharged);
+    }
+
+    // adds the steps to those of the whole solve and checks the clock. A search charges its
+    // steps at least every chargeInterval of them and once more when it ends.
+    void charge(long long steps);
+
+    // for a search that counts its steps one at a time, uncharged is its counter
+    inline bool countStep(long long& uncharged)
+    {
+        if (++uncharged == chargeInterval)
+        {
+            charge(uncharged);
+            uncharged = 0;
+        }
+        return isExhausted(uncharged);
+    }
+
+    bool isExhausted() const;
+
+    // for optional work ahead of the search, like building the oracle: true once the solve is
+    // exhausted or cancelled, or share of its time budget has passed
+    bool isPastShare(double share) const;
+
+    // Solved while there is budget left
+    SolveStatus getStatus() const;
+
+    void offerPartial(std::vector <NodePath> const& pathes, std::size_t depth);
+
+    // throws SolveInterrupted with the deepest partial state
+    [[noreturn]] void interrupt();
+
+private:
+    bool checkLimits(long long uncharged);
+    void exhaust(SolveStatus status);
+
+private:
+    SolveBudget* parent_;
+    std::atomic <bool> const* cancel_; // null without token or flag
+    bool hasDeadline_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point deadline_;
+    long long maxSteps_; // 0 for no limit
+    std::atomic <long long> spent_; // steps charged by all searches
+    std::atomic <bool> exhausted_;
+    std::atomic <SolveStatus> status_;
+
+    std::mutex partialMutex_;
+    std::size_t partialDepth_;
+    std::vector <NodePath> partial_;
+};
+
+#endif // SOLVE_BUDGET_H_INCLUDED
@@ -0,0 +1,74 @@
+#ifndef SOLVE_OPTIONS_H_INCLUDED
+#define SOLVE_OPTIONS_H_INCLUDED
+
+#include "cancellation_token.h"
+
+#include <cstddef>
+
+// the order in which a cursor tries its next steps
+enum class MoveOrdering
+{
+    Fixed, // direction order, NW to SE
+    FewestOptions, // the step leading to the cell with the fewest onward options first (Warnsdorff)
+    DeadEndFirst, // the step to the cell that is closest to becoming a dead end first
+    TowardsTarget, // once the rest of the shape is covered, the step closest to the target first
+    Random // shuffled, see SolveOptions::seed
+};
+
+// how LYNESolver::solve searches
+enum class SolveEngine
+{
+    CursorWalk, // one cursor per shape, walking all shapes together
+    ExactCover, // enumerate the paths of every shape and combine them, see ExactCoverSolver
+    Sat, // encode the board for the SatSolver, see LYNESatEncoder
+    BestFirst // expand the most promising partial state next, see BestFirstSolver
+};
+
+// which cursor makes the next step
+enum class ShapeOrdering
+{
+    Sequential, // complete the shapes in the order of NodeMatrix::getShapeList()
+    MostConstrained, // complete one shape after the other, the most constrained one next
+    Interleaved // every step goes to the most constrained shape
+};
+
+// how SolveEngine::BestFirst rates partial states
+enum class StateScoring
+{
+    RemainingVisits, // fewest valences left to fill
+    Constrainedness, // also prefers paths with few onward options
+    Depth // the deepest state, which makes it depth first
+};
+
+struct SolveOptions
+{
+    SolveEngine engine = SolveEngine::CursorWalk;
+    bool decompose = false; // solve groups of shapes that can not interact on their own, in parallel, sharing the threads
+    unsigned threads = 1; // threads of the cursor walk on one board, 0 uses every core
+    unsigned portfolio = 0; // differently configured cursor walks racing on one board, each on a thread, 0 or 1 for none
+    long long restartSteps = 2000; // steps per unit of the Luby sequence for the restarting portfolio members
+    std::size_t maxCandidatePaths = 2000; // per shape for SolveEngine::ExactCover, boards with more use the cursor walk
+    StateScoring scoring = StateScoring::Constrainedness; // for SolveEngine::BestFirst
+    std::size_t beamWidth = 0; // states kept per depth by SolveEngine::BestFirst, 0 keeps all
+    MoveOrdering ordering = MoveOrdering::DeadEndFirst;
+    ShapeOrdering shapeOrdering = ShapeOrdering::MostConstrained;
+    bool bidirectional = false; // grow every path from both of its ends until they meet
+    bool backjumping = true; // jump back to the last decision a dead end depends on
+    std::size_t nogoodCapacity = 4096; // learned nogoods kept while backjumping, 0 learns none
+    std::size_t transpositionTableBytes = 1 << 20; // memory for states known to fail, 0 disables the table
+    // shapes with up to this many nodes get a HamiltonianOracle table of 4 << nodes bytes, 0 disables it.
+    // A table of n nodes takes O(2^n * n) to build, about 1 ms at 16 nodes, 20 ms at 20 and 300 ms at 24,
+    // more than the search on most boards of that size. At most HamiltonianOracle::maxTableCells.
+    int oracleMaxCells = 16;
+    unsigned seed = 0;
+
+    // LYNESolver::solve gives up once one of these runs out, see SolveBudget
+    long long timeBudgetMs = 0; // wall clock, 0 for no limit
+    // steps of all searches of the solve together, 0 for no limit. A parallel search counts the steps its
+    // workers take below their prefixes, not those of the split that cut the tree or of replaying the prefixes.
+    // The threads charge their steps every SolveBudget::chargeInterval, so each may overrun by that many.
+    long long maxSteps = 0;
+    CancellationToken cancellation;
+};
+
+#endif // SOLVE_OPTIONS_H_INCLUDED
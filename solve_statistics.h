@@ -0,0 +1,31 @@
+#ifndef SOLVE_STATISTICS_H_INCLUDED
+#define SOLVE_STATISTICS_H_INCLUDED
+
+#include <string>
+
+// what a solve did besides steps and backtracks
+struct SolveStatistics
+{
+    long long transpositionHits = 0;
+    long long transpositionMisses = 0;
+    std::string portfolioWinner; // configuration of the portfolio member that decided the board, empty without portfolio
+
+    void add(SolveStatistics const& other)
+    {
+        transpositionHits += other.transpositionHits;
+        transpositionMisses += other.transpositionMisses;
+        if (portfolioWinner.empty())
+            portfolioWinner = other.portfolioWinner;
+    }
+};
+
+// counters of one worker thread, padded so that two workers never share a cache line
+struct WorkerCounters
+{
+    long long stepCounter = 0;
+    long long backtrackCounter = 0;
+    SolveStatistics statistics;
+    char padding[64] = {};
+};
+
+#endif // SOLVE_STATISTICS_H_INCLUDED
@@ -0,0 +1,316 @@
+// Boards the solver once got wrong, and a few more solved with every engine and option.
+// Build it with the solver sources, without main.cpp:
+//   g++ -std=c++11 -I.. solver_regression.cpp <the solver sources> <OpenCV and boost flags>
+// Returns 0 if every board is solved in every configuration.
+
+#include "../batch_solver.h"
+#include "../lyne_solver.h"
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int cellSize = 100;
+
+    // rows split by '/', a cell is '.' or a shape letter (T, D, S, V) and its valence
+    std::vector <std::vector <Node> > parseBoard(std::string const& text)
+    {
+        std::vector <std::vector <std::string> > rows(1);
+        std::istringstream stream(text);
+        std::string token;
+        while (stream >> token)
+        {
+            if (token == "/")
+                rows.emplace_back();
+            else
+                rows.back().push_back(token);
+        }
+
+        std::vector <std::vector <Node> > columns(rows[0].size(), std::vector <Node> (rows.size()));
+        for (std::size_t y = 0; y != rows.size(); ++y)
+        {
+            for (std::size_t x = 0; x != rows[y].size(); ++x)
+            {
+                auto& node = columns[x][y];
+                node.position = cv::Point(static_cast <int> (x) * cellSize, static_cast <int> (y) * cellSize);
+                auto const& cell = rows[y][x];
+                if (cell == ".")
+                    continue;
+
+                switch (cell[0])
+                {
+                case 'T': node.shape = NodeShape::Triangle; break;
+                case 'D': node.shape = NodeShape::Diamond; break;
+                case 'S': node.shape = NodeShape::Square; break;
+                default: node.shape = NodeShape::ValenceRestricted; break;
+                }
+                node.requiredValence = cell[1] - '0';
+            }
+        }
+        return columns;
+    }
+
+    // empty if the paths solve the board
+    std::string checkSolution(std::vector <std::vector <Node> > const& columns, std::vector <NodePath> const& paths)
+    {
+        std::map <std::pair <int, int>, int> valences;
+        std::set <std::pair <std::pair <int, int>, std::pair <int, int> > > edges;
+        for (auto const& path : paths)
+        {
+            for (std::size_t i = 1; i < path.size(); ++i)
+            {
+                auto from = std::make_pair(path[i - 1].x / cellSize, path[i - 1].y / cellSize);
+                auto to = std::make_pair(path[i].x / cellSize, path[i].y / cellSize);
+                if (std::abs(from.first - to.first) > 1 || std::abs(from.second - to.second) > 1 || from == to)
+                    return "steps between cells that are not neighbours";
+
+                auto shape = columns[to.first][to.second].shape;
+                if (shape == NodeShape::Nothing || (shape != NodeShape::ValenceRestricted && shape != columns[path[0].x / cellSize][path[0].y / cellSize].shape))
+                    return "walks over a cell of another shape";
+                if (!edges.insert(std::make_pair(std::min(from, to), std::max(from, to))).second)
+                    return "uses an edge twice";
+                ++valences[from];
+                ++valences[to];
+            }
+        }
+
+        for (std::size_t x = 0; x != columns.size(); ++x)
+        {
+            for (std::size_t y = 0; y != columns[x].size(); ++y)
+            {
+                if (valences[std::make_pair(static_cast <int> (x), static_cast <int> (y))] != columns[x][y].requiredValence)
+                    return "leaves a valence unfilled";
+            }
+        }
+        return {};
+    }
+
+    // false if one of the configurations fails
+    bool checkBoard(std::string const& name, std::string const& board, std::vector <SolveOptions> const& configurations)
+    {
+        auto columns = parseBoard(board);
+        bool passed = true;
+        for (std::size_t i = 0; i != configurations.size(); ++i)
+        {
+            std::string error;
+            try
+            {
+                LYNESolver solver{NodeMatrix(columns)};
+                long long stepCounter = 0;
+                long long backtrackCounter = 0;
+                error = checkSolution(columns, solver.solve(stepCounter, backtrackCounter, configurations[i]));
+            }
+            catch (std::exception const& e)
+            {
+                error = e.what();
+            }
+
+            if (!error.empty())
+            {
+                std::cerr << name << ", configuration " << i << ": " << error << "\n";
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+    // false if one of the configurations ends with another status
+    bool checkStatus(std::string const& name, std::string const& board, std::vector <SolveOptions> const& configurations, SolveStatus expected)
+    {
+        auto columns = parseBoard(board);
+        bool passed = true;
+        for (std::size_t i = 0; i != configurations.size(); ++i)
+        {
+            LYNESolver solver{NodeMatrix(columns)};
+            long long stepCounter = 0;
+            long long backtrackCounter = 0;
+            auto result = solver.trySolve(stepCounter, backtrackCounter, configurations[i]);
+
+            if (result.status != expected)
+            {
+                std::cerr << name << ", configuration " << i << ": status " << static_cast <int> (result.status) << "\n";
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+    // every board solved by solveBatch
+    bool checkBatch(std::vector <std::string> const& boards)
+    {
+        std::vector <NodeMatrix> matrices;
+        for (auto const& i : boards)
+            matrices.emplace_back(parseBoard(i));
+
+        auto results = solveBatch(matrices, SolveOptions(), 2);
+        bool passed = true;
+        for (std::size_t i = 0; i != boards.size(); ++i)
+        {
+            auto error = results[i].error.empty() ? checkSolution(parseBoard(boards[i]), results[i].paths) : results[i].error;
+            if (!error.empty())
+            {
+                std::cerr << "batch, board " << i << ": " << error << "\n";
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+    // every solution is one, and one or several threads find as many
+    bool checkEnumeration(std::string const& name, std::string const& board)
+    {
+        auto columns = parseBoard(board);
+        std::size_t counts[2] = {};
+        bool passed = true;
+        for (int i = 0; i != 2; ++i)
+        {
+            SolveOptions options;
+            options.threads = i == 0 ? 1 : 4;
+            LYNESolver solver{NodeMatrix(columns)};
+            long long stepCounter = 0;
+            long long backtrackCounter = 0;
+            counts[i] = solver.enumerate(stepCounter, backtrackCounter, [&](std::vector <NodePath> const& paths)
+            {
+                auto error = checkSolution(columns, paths);
+                if (!error.empty())
+                {
+                    std::cerr << name << ", enumeration: " << error << "\n";
+                    passed = false;
+                }
+                return true;
+            }, 0, options);
+        }
+
+        if (counts[0] == 0 || counts[0] != counts[1])
+        {
+            std::cerr << name << ", enumeration: " << counts[0] << " solutions on one thread, " << counts[1] << " on four\n";
+            passed = false;
+        }
+        return passed;
+    }
+
+    // the engines and every option of the cursor walk, one at a time next to the defaults
+    std::vector <SolveOptions> getConfigurations()
+    {
+        std::vector <SolveOptions> configurations(1);
+        auto add = [&]() -> SolveOptions&
+        {
+            configurations.emplace_back();
+            return configurations.back();
+        };
+
+        for (auto ordering : {MoveOrdering::Fixed, MoveOrdering::FewestOptions, MoveOrdering::TowardsTarget, MoveOrdering::Random})
+            add().ordering = ordering;
+        for (auto shapeOrdering : {ShapeOrdering::Sequential, ShapeOrdering::Interleaved})
+            add().shapeOrdering = shapeOrdering;
+        add().bidirectional = true;
+        add().backjumping = false;
+        add().nogoodCapacity = 0;
+        add().transpositionTableBytes = 0;
+        add().oracleMaxCells = 0;
+        add().oracleMaxCells = HamiltonianOracle::maxTableCells;
+
+        add().engine = SolveEngine::ExactCover;
+        add().engine = SolveEngine::Sat;
+        for (auto scoring : {StateScoring::RemainingVisits, StateScoring::Constrainedness, StateScoring::Depth})
+        {
+            auto& options = add();
+            options.engine = SolveEngine::BestFirst;
+            options.scoring = scoring;
+        }
+
+        add().decompose = true;
+        add().threads = 2;
+        add().threads = 4;
+        add().portfolio = 3;
+        return configurations;
+    }
+
+    // the cursor walk with every combination of its pruning
+    std::vector <SolveOptions> getCursorWalks(bool bidirectional)
+    {
+        std::vector <SolveOptions> configurations;
+        for (int backjumping = 0; backjumping != 2; ++backjumping)
+        {
+            for (int table = 0; table != 2; ++table)
+            {
+                for (auto shapeOrdering : {ShapeOrdering::Sequential, ShapeOrdering::MostConstrained, ShapeOrdering::Interleaved})
+                {
+                    SolveOptions options;
+                    options.bidirectional = bidirectional;
+                    options.backjumping = backjumping != 0;
+                    options.transpositionTableBytes = table != 0 ? options.transpositionTableBytes : 0;
+                    options.shapeOrdering = shapeOrdering;
+                    configurations.push_back(options);
+                }
+            }
+        }
+        return configurations;
+    }
+}
+
+int main()
+{
+    bool passed = true;
+
+    // all of them solvable, the last two have independent groups of shapes
+    std::vector <std::string> boards = {
+        "T1 T2 T1 / V2 V2 . / V2 . .",
+        ". . . / T1 . . / . V4 V2 / V2 V2 T1",
+        "T1 T2 T2 T2 T2 / T2 T2 T2 T2 T2 / T2 T2 T2 T2 T2 / T2 T2 T2 T2 T1",
+        "T2 T2 V4 T1 . . / T2 V4 D1 D2 D2 . / T1 . V4 V4 S2 . / D2 D2 S2 D2 S2 S2 / S2 V4 S2 V4 S1 . / S1 S2 D2 D1 . .",
+        "T1 T2 T1 . D1 D2 / . . . . . D1",
+        "T1 T2 . S1 S2 S2 / . T1 . . . S1 / D1 D2 D2 D2 D2 D1"
+    };
+    auto configurations = getConfigurations();
+    for (std::size_t i = 0; i != boards.size(); ++i)
+    {
+        passed &= checkBoard("board " + std::to_string(i), boards[i], configurations);
+        passed &= checkEnumeration("board " + std::to_string(i), boards[i]);
+    }
+    passed &= checkBatch(boards);
+
+    // every cursor finished while valence restricted nodes were open, backjumping read cursors_[-1]
+    passed &= checkBoard("finished with open nodes", "T1 T2 T1 / V2 V2 . / V2 . .", getCursorWalks(false));
+
+    // the fronts meet on the V4 with the triangles done, the path has to loop through it once more
+    auto meetings = getCursorWalks(true);
+    meetings.push_back(SolveOptions());
+    meetings.back().engine = SolveEngine::Sat;
+    passed &= checkBoard("fronts meeting on a valence restricted node", ". . . / T1 . . / . V4 V2 / V2 V2 T1", meetings);
+
+    // the portfolio threads made their searches outside the try, the invalid board terminated the process
+    std::vector <SolveOptions> portfolios(2);
+    portfolios[1].portfolio = 4;
+    passed &= checkStatus("invalid board", "T1 T2 T2", portfolios, SolveStatus::NoSolution);
+
+    // the oracle table took longer to build than the whole time budget, the search never started
+    std::vector <SolveOptions> tightBudgets(2);
+    tightBudgets[0].oracleMaxCells = 20;
+    tightBudgets[1].oracleMaxCells = HamiltonianOracle::maxTableCells;
+    for (auto& i : tightBudgets)
+        i.timeBudgetMs = 10;
+    passed &= checkStatus("tight budget on an easy board", "T1 T2 T2 T2 T2 / T2 T2 T2 T2 T2 / T2 T2 T2 T2 T2 / T2 T2 T2 T2 T1", tightBudgets,
+                          SolveStatus::Solved);
+
+    // maxSteps counts the steps of all threads together, one search alone needs 202 of them
+    std::vector <SolveOptions> threadCounts(5);
+    threadCounts[1].threads = 2;
+    threadCounts[2].threads = 4;
+    threadCounts[3].portfolio = 3;
+    threadCounts[4].portfolio = 3;
+    threadCounts[4].threads = 4;
+    for (auto& i : threadCounts)
+        i.maxSteps = 2000;
+    passed &= checkStatus("generous step budget on any number of threads",
+                          "T2 T2 V4 T1 . . / T2 V4 D1 D2 D2 . / T1 . V4 V4 S2 . / D2 D2 S2 D2 S2 S2 / S2 V4 S2 V4 S1 . / S1 S2 D2 D1 . .",
+                          threadCounts, SolveStatus::Solved);
+
+    std::cout << (passed ? "passed" : "FAILED") << "\n";
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+#include "transposition_table.h"
+
+constexpr std::size_t TranspositionTable::bucketSize;
+
+TranspositionTable::TranspositionTable (std::size_t bytes)
+    : entries_()
+    , bucketMask_(0)
+{
+    // a power of two of buckets, as many as fit
+    std::size_t buckets = 1;
+    while (buckets * 2 * bucketSize * sizeof(Entry) <= bytes)
+        buckets *= 2;
+
+    if (buckets * bucketSize * sizeof(Entry) > bytes)
+        return;
+
+    // hash 0 marks an empty entry, the empty board is never stored.
+    entries_.assign(buckets * bucketSize, Entry{0, 0});
+    bucketMask_ = buckets - 1;
+}
+
+bool TranspositionTable::contains(std::uint64_t hash) const
+{
+    if (!isEnabled())
+        return false;
+
+    auto bucket = getBucket(hash);
+    for (std::size_t i = 0; i != bucketSize; ++i)
+        if (bucket[i].hash == hash)
+            return true;
+    return false;
+}
+
+void TranspositionTable::insert(std::uint64_t hash, long long work)
+{
+    if (!isEnabled() || hash == 0)
+        return;
+
+    // an empty entry first, cheap failures have no work to tell them from one.
+    auto bucket = getBucket(hash);
+    Entry* empty = nullptr;
+    auto victim = bucket;
+    for (std::size_t i = 0; i != bucketSize; ++i)
+    {
+        if (bucket[i].hash == hash)
+        {
+            if (bucket[i].work < work)
+                bucket[i].work = work;
+            return;
+        }
+        if (bucket[i].hash == 0 && empty == nullptr)
+            empty = bucket + i;
+        if (bucket[i].work < victim->work)
+            victim = bucket + i;
+    }
+    *(empty != nullptr ? empty : victim) = {hash, work};
+}
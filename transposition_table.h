@@ -0,0 +1,50 @@
+#ifndef TRANSPOSITION_TABLE_H_INCLUDED
+#define TRANSPOSITION_TABLE_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Hashes of search states that are known to have no solution.
+ *  The table is split into buckets of a few entries. A full bucket gives up the entry that
+ *  took the least work to prove, so expensive failures stay around longest.
+ */
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable (std::size_t bytes);
+
+    bool contains(std::uint64_t hash) const;
+    void insert(std::uint64_t hash, long long work);
+
+    inline bool isEnabled() const
+    {
+        return !entries_.empty();
+    }
+
+private:
+    struct Entry
+    {
+        std::uint64_t hash;
+        long long work;
+    };
+
+    static constexpr std::size_t bucketSize = 4;
+
+    inline Entry* getBucket(std::uint64_t hash)
+    {
+        return entries_.data() + (hash & bucketMask_) * bucketSize;
+    }
+
+    inline Entry const* getBucket(std::uint64_t hash) const
+    {
+        return entries_.data() + (hash & bucketMask_) * bucketSize;
+    }
+
+private:
+    std::vector <Entry> entries_;
+    std::uint64_t bucketMask_;
+};
+
+#endif // TRANSPOSITION_TABLE_H_INCLUDED
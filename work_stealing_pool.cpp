@@ -0,0 +1,82 @@
+#include "work_stealing_pool.h"
+
+#include <thread>
+
+WorkStealingPool::WorkStealingPool (unsigned threads)
+    : threadCount_(threads == 0 ? 1 : threads)
+    , queues_()
+    , failureMutex_()
+{
+    for (unsigned i = 0; i != threadCount_; ++i)
+        queues_.emplace_back(new Queue());
+}
+
+unsigned WorkStealingPool::getThreadCount() const
+{
+    return threadCount_;
+}
+
+void WorkStealingPool::run(std::vector <Task> tasks)
+{
+    for (std::size_t i = 0; i != tasks.size(); ++i)
+        queues_[i % threadCount_]->tasks.push_back(std::move(tasks[i]));
+
+    std::exception_ptr failure;
+    std::vector <std::thread> threads;
+    for (unsigned i = 1; i < threadCount_; ++i)
+        threads.emplace_back(&WorkStealingPool::work, this, i, std::ref(failure));
+    work(0, failure);
+    for (auto& i : threads)
+        i.join();
+
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+bool WorkStealingPool::takeOwn(unsigned worker, Task& task)
+{
+    auto& queue = *queues_[worker];
+    std::lock_guard <std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, Task& task)
+{
+    // the front holds the tasks the owner would take last
+    for (unsigned i = 1; i != threadCount_; ++i)
+    {
+        auto& queue = *queues_[(thief + i) % threadCount_];
+        std::lock_guard <std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::work(unsigned worker, std::exception_ptr& failure)
+{
+    // no task adds new ones, so a worker that finds nothing anywhere is done.
+    Task task;
+    while (takeOwn(worker, task) || steal(worker, task))
+    {
+        try
+        {
+            task(worker);
+        }
+        catch (...)
+        {
+            std::lock_guard <std::mutex> lock(failureMutex_);
+            if (!failure)
+                failure = std::current_exception();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef WORK_STEALING_POOL_H_INCLUDED
+#define WORK_STEALING_POOL_H_INCLUDED
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ *  Runs a batch of tasks on a fixed number of threads. Every thread works off its own
+ *  queue from the back and, once that is empty, steals from the front of the others.
+ *  The calling thread is one of the workers.
+ */
+class WorkStealingPool
+{
+public:
+    // the worker running it, for per worker state
+    using Task = std::function <void (unsigned worker)>;
+
+    explicit WorkStealingPool (unsigned threads);
+
+    unsigned getThreadCount() const;
+
+    // deals the tasks round robin and returns once all of them ran. The first exception
+    // a task throws is rethrown after that.
+    void run(std::vector <Task> tasks);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque <Task> tasks;
+    };
+
+    bool takeOwn(unsigned worker, Task& task);
+    bool steal(unsigned thief, Task& task);
+    void work(unsigned worker, std::exception_ptr& failure);
+
+private:
+    unsigned threadCount_;
+    std::vector <std::unique_ptr <Queue> > queues_;
+    std::mutex failureMutex_;
+};
+
+#endif // WORK_STEALING_POOL_H_INCLUDED